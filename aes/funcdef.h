@@ -1,7 +1,7 @@
 /*      FUNCDEF.H
 *
 *       Copyright 1999, Caldera Thin Clients, Inc.
-*       Copyright (C) 2016 The EmuTOS development team
+*       Copyright (C) 2016-2018 The EmuTOS development team
 *
 *       This software is licenced under the GNU Public License.
 *       Please see LICENSE.TXT for further information.
@@ -85,6 +85,7 @@
 
 #define SHOW_CUR                122
 #define HIDE_CUR                123
+#define HIDE_DEFERRED           1       /* EmuTOS extension: intin[0] for HIDE_CUR */
 #define MOUSE_ST                124
 #define BUT_VECX                125
 #define MOT_VECX                126
@@ -93,4 +94,6 @@
 #define TEXT_CLIP               129
 #define WHEEL_VECX              134
 
+#define BATCH_COMMANDS          250     /* EmuTOS extension */
+
 #endif  /* _FUNCDEF_H */
@@ -33,6 +33,7 @@
 #include "gemmnlib.h"
 #include "gemdosif.h"
 #include "gemasm.h"
+#include "gemqueue.h"
 #include "gemdisp.h"
 #include "gemaplib.h"
 #include "gsx2.h"
@@ -75,8 +76,7 @@ WORD ap_rdwr(WORD code, AESPD *p, WORD length, WORD *pbuff)
      */
     if ((code == MU_MESAG) && (p->p_qindex == length) && (length == 16))
     {
-        memcpy(pbuff, p->p_qaddr, p->p_qindex);
-        p->p_qindex = 0;
+        aq_read(p, pbuff, length);
         return 0;
     }
 
@@ -233,6 +233,21 @@ WORD ap_trecd(EVNTREC *pbuff,WORD length)
     return length;
 }
 
+/*
+ *  Discard any messages in the queue of the current process
+ */
+void ap_flush(void)
+{
+    WORD n, len;
+
+    for (n = rlr->p_qindex; n > 0; n -= len)
+    {
+        len = min(n, sizeof(D.g_valstr));
+        ap_rdwr(MU_MESAG, rlr, len, (WORD *)D.g_valstr);
+    }
+}
+
+
 /*
  *  APplication EXIT
  */
@@ -241,8 +256,7 @@ void ap_exit(void)
     wm_update(BEG_UPDATE);
     mn_clsda();
     wait_for_accs(AP_ACCLOSE);  /* block until all DAs have seen AC_CLOSE */
-    if (rlr->p_qindex)
-        ap_rdwr(MU_MESAG, rlr, rlr->p_qindex, (WORD *)D.g_valstr);
+    ap_flush();
     set_mouse_to_arrow();
     wm_update(END_UPDATE);
     all_run();
@@ -37,6 +37,7 @@ WORD ap_rdwr(WORD code, AESPD *p, WORD length, WORD *pbuff);
 WORD ap_find(char *pname);
 void ap_tplay(const EVNTREC *pbuff, WORD length, WORD scale);
 WORD ap_trecd(EVNTREC *pbuff, WORD length);
+void ap_flush(void);
 void ap_exit(void);
 
 #endif
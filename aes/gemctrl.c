@@ -291,7 +291,7 @@ void ct_mouse(WORD grabit)
     else
     {
         if (gl_tmpmoff)
-            gsx_moff();
+            gsx_mhide();
         gl_moff = gl_tmpmoff;
         gsx_mfset(&gl_mouse);
         gl_ctmown = FALSE;
@@ -38,6 +38,7 @@
 #include "optimize.h"
 #include "gemdosif.h"
 #include "kprint.h"
+#include "biosbind.h"
 
 #include "asm.h"
 
@@ -46,6 +47,12 @@
 
 
 /* forkq puts a fork block with a routine in the fork ring      */
+/*                                                              */
+/* consecutive mouse movements are coalesced: if the most       */
+/* recently queued block is also a mouse movement, it is just   */
+/* updated with the new position.  a movement that follows a    */
+/* button or key event is still queued separately, so events    */
+/* are always processed in order.                               */
 
 void forkq(FCODE fcode, LONG fdata)
 {
@@ -54,6 +61,15 @@ void forkq(FCODE fcode, LONG fdata)
     /* q a fork process, enter with ints OFF */
     if (fpcnt == 0)
         fpt = fph = 0;
+    else if (fcode == mchange)
+    {
+        f = &D.g_fpdx[(fpt ? fpt : NFORKS) - 1];
+        if (f->f_code == mchange)
+        {
+            f->f_data = fdata;
+            return;
+        }
+    }
 
     if (fpcnt < NFORKS)
     {
@@ -171,6 +187,23 @@ void chkkbd(void)
 }
 
 
+/*
+ *  Return TRUE if chkkbd() may have something to report
+ *
+ *  chkkbd() gets the keyboard input via several VDI calls, which is
+ *  relatively slow.  since the scheduler polls the keyboard each time
+ *  it runs, including each time an idle system is woken by an interrupt,
+ *  we first ask the BIOS if there is a new key or shift state.
+ */
+static BOOL kbd_changed(void)
+{
+    if (gl_play)
+        return FALSE;
+
+    return Bconstat(2) || ((WORD)(Kbshift(-1) & 0x000f) != kstate);
+}
+
+
 static void schedule(void)
 {
     AESPD *p;
@@ -181,7 +214,8 @@ static void schedule(void)
     for (;;)
     {
         /* poll the keyboard    */
-        chkkbd();
+        if (kbd_changed())
+            chkkbd();
         /* now move drl processes to rlr */
         while (drl)
         {
@@ -39,15 +39,18 @@
 
 #define LEN_FSNAME (LEN_ZFNAME+1)   /* includes leading flag byte & trailing nul */
 #define LEN_FSPATH  (LEN_ZPATH+4)   /* at least 3 bytes longer than max path */
-#define LEN_FSWORK  (3*LEN_FSPATH)  /* total workarea length in fs_input() */
+#define LEN_FSWORK  (4*LEN_FSPATH)  /* total workarea length in fs_input() */
 
 static GRECT gl_rfs;
 
 static const char gl_fsobj[4] = {FTITLE, FILEBOX, SCRLBAR, 0x0};
 
 static char *ad_fsnames;    /* holds filenames in currently-displayed directory */
-static LONG *g_fslist;      /* offsets of filenames within ad_fsnames */
-static LONG nm_files;       /* total number of slots in g_fslist[] */
+static LONG *g_fslist;      /* offsets of displayed filenames within ad_fsnames */
+static LONG *g_fsall;       /* offsets of all filenames, sorted */
+static LONG nm_files;       /* total number of slots in g_fslist[] & g_fsall[] */
+static LONG nm_all;         /* number of filenames in g_fsall[] */
+static char *fs_curdir;     /* directory (with "*.*") in g_fsall[], or empty */
 
 
 /*
@@ -152,7 +155,7 @@ static LONG fs_add(WORD thefile, LONG fs_index)
 {
     WORD len;
 
-    g_fslist[thefile] = fs_index;
+    g_fsall[thefile] = fs_index;
     ad_fsnames[fs_index++] = (D.g_dta.d_attrib & F_SUBDIR) ? 0x07 : ' ';
     len = strlencpy(ad_fsnames+fs_index,D.g_dta.d_fname);
     fs_index += len + 1;
@@ -161,29 +164,21 @@ static LONG fs_add(WORD thefile, LONG fs_index)
 
 
 /*
- *  Make a particular path the active path.  This involves
- *  reading its directory, initializing a file list, and filling
- *  out the information in the path node.  Then sort the files.
+ *  Read all the files & folders in a directory into g_fsall[], and sort
+ *  them.  'allpath' is the directory path, followed by "*.*".
  *
- *  Returns FALSE iff error occurred
+ *  Returns the GEMDOS error code that ended the search
  */
-static WORD fs_active(char *ppath, char *pspec, WORD *pcount)
+static WORD fs_readdir(char *allpath)
 {
     WORD ret;
     LONG thefile, fs_index, temp;
     WORD i, j, gap;
-    char *fname, allpath[LEN_ZPATH+1];
     DTA *user_dta;
 
-    set_mouse_to_hourglass();
-
     thefile = 0L;
     fs_index = 0L;
 
-    strcpy(allpath, ppath);         /* 'allpath' gets all files */
-    fname = fs_pspec(allpath,NULL);
-    strcpy(fname,"*.*");
-
     user_dta = dos_gdta();          /* remember user's DTA */
     dos_sdta(&D.g_dta);
     ret = dos_sfirst(allpath, F_SUBDIR);
@@ -195,11 +190,8 @@ static WORD fs_active(char *ppath, char *pspec, WORD *pcount)
          */
         if (D.g_dta.d_fname[0] != '.')
         {
-            if ((D.g_dta.d_attrib & F_SUBDIR) || (wildcmp(pspec, D.g_dta.d_fname)))
-            {
-                fs_index = fs_add(thefile, fs_index);
-                thefile++;
-            }
+            fs_index = fs_add(thefile, fs_index);
+            thefile++;
         }
         ret = dos_snext();
 
@@ -210,7 +202,7 @@ static WORD fs_active(char *ppath, char *pspec, WORD *pcount)
         }
     }
 
-    *pcount = thefile;
+    nm_all = thefile;
     dos_sdta(user_dta);             /* restore user DTA */
 
     /* sort files using shell sort from page 108 of K&R C Prog. Lang. */
@@ -220,18 +212,65 @@ static WORD fs_active(char *ppath, char *pspec, WORD *pcount)
         {
             for (j = i-gap; j >= 0; j -= gap)
             {
-                if (fs_comp(ad_fsnames+g_fslist[j],ad_fsnames+g_fslist[j+gap]) <= 0)
+                if (fs_comp(ad_fsnames+g_fsall[j],ad_fsnames+g_fsall[j+gap]) <= 0)
                     break;
-                temp = g_fslist[j];
-                g_fslist[j] = g_fslist[j+gap];
-                g_fslist[j+gap] = temp;
+                temp = g_fsall[j];
+                g_fsall[j] = g_fsall[j+gap];
+                g_fsall[j+gap] = temp;
             }
         }
     }
 
+    return ret;
+}
+
+
+/*
+ *  Make a particular path the active path.  This involves
+ *  reading its directory, initializing a file list, and filling
+ *  out the information in the path node.  Then sort the files.
+ *
+ *  The sorted list of all the files in the directory is kept, so
+ *  that if only the mask has changed, the directory need not be
+ *  read again: the list of files to display is just filtered from
+ *  it (which preserves the sort order).  Clearing fs_curdir forces
+ *  the directory to be read.
+ *
+ *  Returns FALSE iff error occurred
+ */
+static WORD fs_active(char *ppath, char *pspec, WORD *pcount)
+{
+    WORD ret;
+    LONG i, thefile;
+    char *fname, *p, allpath[LEN_ZPATH+1];
+
+    set_mouse_to_hourglass();
+
+    strcpy(allpath, ppath);         /* 'allpath' gets all files */
+    fname = fs_pspec(allpath,NULL);
+    strcpy(fname,"*.*");
+
+    ret = 0;
+    if (strcmp(allpath, fs_curdir) != 0)
+    {
+        ret = fs_readdir(allpath);
+        if ((ret == EFILNF) || (ret == ENMFIL))
+            ret = 0;
+        strcpy(fs_curdir, ret ? "" : allpath);
+    }
+
+    /* select the files & folders to display */
+    for (i = 0, thefile = 0; i < nm_all; i++)
+    {
+        p = ad_fsnames + g_fsall[i];
+        if ((*p == 0x07) || wildcmp(pspec, p+1))
+            g_fslist[thefile++] = g_fsall[i];
+    }
+    *pcount = thefile;
+
     set_mouse_to_arrow();
 
-    if ((ret == EFILNF) || (ret == ENMFIL))
+    if (ret == 0)
         return TRUE;
 
     if (!IS_BIOS_ERROR(ret))    /* if BDOS error, issue message via form_error(): */
@@ -546,16 +585,18 @@ WORD fs_input(char *pipath, char *pisel, WORD *pbutton, char *pilabel)
      * (this also happily reduces code size).
      *
      * the order of data within the gotten area is:
-     *  filename pointers
+     *  filename pointers (displayed)
+     *  filename pointers (all)
      *  filename array
      *  locstr
      *  locold
      *  mask
+     *  fs_curdir
      */
     memblk = NULL;
-    nm_files = (dos_avail_anyram()-LEN_FSWORK) / (LEN_FSNAME+sizeof(char *));
+    nm_files = (dos_avail_anyram()-LEN_FSWORK) / (LEN_FSNAME+2*sizeof(LONG));
     if (nm_files >= NM_NAMES)
-        memblk = dos_alloc_anyram(nm_files*(LEN_FSNAME+sizeof(char *))+LEN_FSWORK);
+        memblk = dos_alloc_anyram(nm_files*(LEN_FSNAME+2*sizeof(LONG))+LEN_FSWORK);
     if (!memblk)
     {
         fm_show(ALFSMEM, NULL, 1);
@@ -563,10 +604,14 @@ WORD fs_input(char *pipath, char *pisel, WORD *pbutton, char *pilabel)
     }
 
     g_fslist = (LONG *)memblk;
-    ad_fsnames = (char *)(g_fslist+nm_files);
+    g_fsall = g_fslist + nm_files;
+    ad_fsnames = (char *)(g_fsall+nm_files);
     locstr = ad_fsnames + (nm_files * LEN_FSNAME);
     locold = locstr + LEN_FSPATH;
     mask = locold + LEN_FSPATH;
+    fs_curdir = mask + LEN_FSPATH;
+    fs_curdir[0] = '\0';
+    nm_all = 0;
 
     strcpy(locstr, pipath);
     strcpy(locold,locstr);
@@ -764,6 +809,14 @@ WORD fs_input(char *pipath, char *pisel, WORD *pbutton, char *pilabel)
                 newdrive = TRUE;
             else
                 newlist = TRUE;
+            /*
+             * a new directory is always read, but for a mask change the
+             * list in g_fsall[] is reused.  on a floppy drive we read it
+             * anyway, since editing the mask is how the user refreshes
+             * the list after changing disks.
+             */
+            if (get_drive(ad_fpath) < 2)
+                fs_curdir[0] = '\0';
             strcpy(locstr, ad_fpath);
         }
 
@@ -79,6 +79,12 @@ GLOBAL GRECT    gl_rmenu;
 static WORD     gl_xclip;
 static WORD     gl_yclip;
 
+#if CONF_WITH_VDI_EXTENSIONS
+static const GRECT *gl_region;  /* current clip region (see gsx_sregion()) */
+static WORD     gl_nregion;     /* number of rectangles in it, 0 if none */
+static WORD     region_pxy[4*MAX_REGION_RECTS];
+#endif
+
 /*
  * the following are used to save the currently-set values for
  * various VDI attributes, in order to save unnecessary VDI calls
@@ -104,6 +110,9 @@ static WORD     gl_hsptschar;
 void gsx_sclip(const GRECT *pt)
 {
     r_get(pt, &gl_xclip, &gl_yclip, &gl_wclip, &gl_hclip);
+#if CONF_WITH_VDI_EXTENSIONS
+    gl_nregion = 0;
+#endif
 
     if (gl_wclip && gl_hclip)
     {
@@ -118,6 +127,64 @@ void gsx_sclip(const GRECT *pt)
 }
 
 
+#if CONF_WITH_VDI_EXTENSIONS
+/*
+ *  Routine to set a clip region consisting of several (non-overlapping)
+ *  rectangles, so that something can be drawn once for all of them.
+ *  The list must remain valid until the clip is changed again.  The
+ *  current clip rectangle becomes the bounding box of the region.
+ *
+ *  Clip regions are an EmuTOS VDI extension: if the VDI does not support
+ *  them, we return FALSE, and the caller must draw once per rectangle.
+ */
+BOOL gsx_sregion(const GRECT *prect, WORD count)
+{
+    WORD    i, *p;
+    GRECT   bounds;
+
+    if ((count < 1) || (count > MAX_REGION_RECTS))
+        return FALSE;
+
+    rc_copy(prect, &bounds);
+    for (i = 0, p = region_pxy; i < count; i++)
+    {
+        *p++ = prect[i].g_x;
+        *p++ = prect[i].g_y;
+        *p++ = prect[i].g_x + prect[i].g_w - 1;
+        *p++ = prect[i].g_y + prect[i].g_h - 1;
+        rc_union(&prect[i], &bounds);
+    }
+
+    i_ptsin(region_pxy);
+    intin[0] = TRUE;
+    contrl[4] = 0;              /* other VDIs return nothing */
+    gsx_ncode(TEXT_CLIP, 2*count, 1);
+    i_ptsin(ptsin);
+
+    if ((contrl[4] == 0) || (intout[0] == 0))
+        return FALSE;
+
+    r_get(&bounds, &gl_xclip, &gl_yclip, &gl_wclip, &gl_hclip);
+    gl_region = prect;
+    gl_nregion = count;
+
+    return TRUE;
+}
+
+
+/*
+ *  Routine to get the current clip region: returns the number of
+ *  rectangles, or 0 if there is just a clip rectangle
+ */
+WORD gsx_gregion(const GRECT **pprect)
+{
+    *pprect = gl_region;
+
+    return gl_nregion;
+}
+#endif
+
+
 /*
  *  Routine to get the current clip setting
  */
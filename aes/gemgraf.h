@@ -12,6 +12,13 @@
 
 #include "gsxdefs.h"
 
+#if CONF_WITH_VDI_EXTENSIONS
+#define MAX_REGION_RECTS    32  /* max rectangles in a clip region, as in VDI */
+
+BOOL gsx_sregion(const GRECT *prect, WORD count);
+WORD gsx_gregion(const GRECT **pprect);
+#endif
+
 WORD gsx_chkclip(GRECT *pt);
 void gsx_cline(UWORD x1, UWORD y1, UWORD x2, UWORD y2);
 void gsx_xbox(GRECT *pt);
@@ -202,7 +202,7 @@ void ratinit(void)
 
 void ratexit(void)
 {
-    gsx_moff();
+    gsx_mhide();
 }
 
 
@@ -391,16 +391,46 @@ WORD gsx_kstate(void)
 
 
 
+/*
+ *  Hide the mouse for drawing by the AES
+ *
+ *  With the EmuTOS VDI, the cursor is only actually removed from the
+ *  screen if something is drawn over it; other VDIs ignore the extra
+ *  parameter and remove it immediately
+ */
 void gsx_moff(void)
 {
     if (!gl_moff)
+    {
+#if CONF_WITH_VDI_EXTENSIONS
+        gsx_1code(HIDE_CUR, HIDE_DEFERRED);
+#else
         gsx_ncode(HIDE_CUR, 0, 0);
+#endif
+    }
 
     gl_moff++;
 }
 
 
 
+/*
+ *  Hide the mouse, making sure that it is removed from the screen
+ *
+ *  This must be used instead of gsx_moff() when the screen may be written
+ *  other than via the VDI, i.e. by the application
+ */
+void gsx_mhide(void)
+{
+    gsx_moff();
+#if CONF_WITH_VDI_EXTENSIONS
+    gsx_ncode(HIDE_CUR, 0, 0);  /* remove a deferred-hidden cursor ... */
+    gsx_1code(SHOW_CUR, 1);     /* ... without changing the hide count */
+#endif
+}
+
+
+
 void gsx_mon(void)
 {
     gl_moff--;
@@ -42,6 +42,7 @@ void gsx_mxmy(WORD *pmx, WORD *pmy);
 WORD gsx_kstate(void);
 void gsx_mon(void);
 void gsx_moff(void);
+void gsx_mhide(void);
 WORD gsx_char(void);
 void gsx_setmousexy(WORD x, WORD y);
 WORD gsx_nplanes(void);
@@ -53,6 +53,7 @@
 #include "gemaplib.h"
 #include "geminput.h"
 #include "gemmnlib.h"
+#include "gemprof.h"
 #include "geminit.h"
 #include "optimize.h"
 #include "aespub.h"
@@ -114,6 +115,7 @@ GLOBAL const GEM_MUPB ui_mupb =
 
 GLOBAL WORD     totpds;
 GLOBAL WORD     num_accs;
+GLOBAL WORD     num_wins;       /* number of entries in the window tables */
 
 GLOBAL char     *ad_envrn;              /* initialized in GEMSTART      */
 
@@ -748,7 +750,31 @@ void gem_main(void)
         memset(D.g_acc,0x00,num_accs*sizeof(AESPROCESS));
     else num_accs = 0;
 
+    /*
+     * allocate the window tables and the owner rectangles in one block.
+     * if there is not enough memory for NUM_WIN windows, make do with
+     * fewer.
+     */
+    for (num_wins = NUM_WIN; ; num_wins /= 2)
+    {
+        D.w_win = dos_alloc_anyram(num_wins*WINDOW_MEMSIZE);
+        if (D.w_win)
+            break;
+        if (num_wins <= MIN_WIN)
+            panic("no memory for window tables\n");
+    }
+    D.w_tree = (OBJECT *)(D.w_win + num_wins);
+    D.g_olist = (ORECT *)(D.w_tree + num_wins);
+
     totpds = num_accs + 2;
+    sh = dos_alloc_anyram(totpds*sizeof(SHELL));
+    if (!sh)
+        panic("no memory for shell table\n");
+    memset(sh, 0x00, totpds*sizeof(SHELL));
+
+#if CONF_WITH_AES_PROFILE
+    prof_init();
+#endif
 
     disable_interrupts();
     set_aestrap();                  /* set trap#2 -> aestrap */
@@ -793,7 +819,7 @@ void gem_main(void)
             rlr->p_uda = &D.g_acc[i-2].a_uda;
             rlr->p_cda = &D.g_acc[i-2].a_cda;
         }
-        rlr->p_qaddr = rlr->p_queue;
+        rlr->p_qhead = 0;
         rlr->p_qindex = 0;
         memset(rlr->p_name, ' ', AP_NAMELEN);
         rlr->p_appdir[0] = '\0'; /* by default, no application directory */
@@ -829,6 +855,9 @@ void gem_main(void)
     unset_aestrap();
     enable_interrupts();
 
+    dos_free(sh);
+    if (D.w_win)
+        dos_free(D.w_win);
     if (D.g_acc)
         dos_free(D.g_acc);
 }
@@ -21,6 +21,7 @@ extern MFORM    gl_mouse;
 
 extern WORD     totpds;
 extern WORD     num_accs;
+extern WORD     num_wins;
 
 extern THEGLO   D;
 
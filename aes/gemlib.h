@@ -98,7 +98,13 @@ typedef struct window
     ORECT *w_rnext;             /* used for search first, search next */
 } WINDOW;
 
-#define NUM_ORECT (NUM_WIN * 10)        /* is this enough???    */
+/*
+ * the window tables (see THEGLO) are allocated at startup, for NUM_WIN
+ * windows if possible, but for no fewer than MIN_WIN
+ */
+#define MIN_WIN         4
+#define ORECTS_PER_WIN  32      /* owner rectangles allocated per window */
+#define WINDOW_MEMSIZE  (sizeof(WINDOW)+sizeof(OBJECT)+ORECTS_PER_WIN*sizeof(ORECT))
 
 #define WS_FULL 0
 #define WS_CURR 1
@@ -207,14 +213,14 @@ typedef struct
     DTA   g_dta;                /* AES's DTA */
 
     FPD   g_fpdx[NFORKS];       /* the fork ring, used by gemdisp.c */
-    ORECT g_olist[NUM_ORECT];
 
     char  g_rawstr[MAX_LEN];
     char  g_tmpstr[MAX_LEN];
     char  g_valstr[MAX_LEN];
     char  g_fmtstr[MAX_LEN];
 
-    WINDOW w_win[NUM_WIN];
+    WINDOW *w_win;              /* window table, allocated at startup */
+    OBJECT *w_tree;             /* window extent objects, ditto */
 
     WORD  g_accreg;             /* number of entries used in g_acctitle[] */
     char  *g_acctitle[NUM_ACCS];/* used by menu_register(). must always   */
@@ -222,6 +228,7 @@ typedef struct
                                 /*   more than one menu_register()!       */
 
     AESPROCESS *g_acc;          /* for up to NUM_ACCS desk accessories */
+    ORECT *g_olist;             /* owner rectangles, ORECTS_PER_WIN per window */
 } THEGLO;
 
 #endif /* GEMLIB_H */
@@ -32,6 +32,7 @@
 #include "optimopt.h"
 #include "rectfunc.h"
 #include "gemoblib.h"
+#include "gsx2.h"
 
 #include "string.h"
 #include "kprint.h"
@@ -176,6 +177,10 @@ static WORD ob_user(OBJECT *tree, WORD obj, GRECT *pt, LONG spec,
 {
     PARMBLK pb;
     USERBLK *ub = (USERBLK *)spec;
+#if CONF_WITH_VDI_EXTENSIONS
+    const GRECT *region;
+    WORD n, i, ret;
+#endif
 
     pb.pb_tree = tree;
     pb.pb_obj = obj;
@@ -185,6 +190,38 @@ static WORD ob_user(OBJECT *tree, WORD obj, GRECT *pt, LONG spec,
     gsx_gclip((GRECT *)&pb.pb_xc);      /* FIXME: ditto */
     pb.pb_parm = ub->ub_parm;
 
+#if CONF_WITH_VDI_EXTENSIONS
+    /*
+     * the user code may not use the VDI, so really remove the mouse.
+     * we are inside ob_draw()'s batch, so the VDI calls made here must
+     * be flushed, along with anything pending, before the user code draws.
+     */
+    if (gl_moff)
+    {
+        gsx_mhide();
+        gsx_mon();
+    }
+    gsx_batch_flush();
+
+    /*
+     * the user code only knows about the clip rectangle, so with a clip
+     * region it is called once per rectangle
+     */
+    n = gsx_gregion(&region);
+    if (n)
+    {
+        for (i = 0, ret = 0; i < n; i++)
+        {
+            gsx_sclip(&region[i]);
+            gsx_batch_flush();
+            rc_copy(&region[i], (GRECT *)&pb.pb_xc);
+            ret = call_usercode(ub, &pb);
+        }
+        gsx_sregion(region, n);
+        return ret;
+    }
+#endif
+
     return call_usercode(ub, &pb);
 }
 
@@ -432,9 +469,15 @@ void ob_draw(OBJECT *tree, WORD obj, WORD depth)
     else
         sx = sy = 0;
 
+#if CONF_WITH_VDI_EXTENSIONS
+    gsx_batch_begin();
+#endif
     gsx_moff();
     everyobj(tree, obj, last, just_draw, sx, sy, depth);
     gsx_mon();
+#if CONF_WITH_VDI_EXTENSIONS
+    gsx_batch_end();
+#endif
 }
 
 
@@ -473,18 +516,19 @@ static WORD get_prev(OBJECT *tree, WORD parent, WORD obj)
  *
  *  Since each parent object contains its children the idea is to
  *  walk down the tree, limited by the depth parameter, and find
- *  the last object the mx,my location was over.
+ *  the last object the mx,my location was over.  Where siblings
+ *  overlap, the one that is drawn last (i.e. the one nearest the
+ *  end of the list) is on top, so the children of each object are
+ *  checked in list order, remembering the last one that matches.
  */
 WORD ob_find(OBJECT *tree, WORD currobj, WORD depth, WORD mx, WORD my)
 {
-    WORD lastfound;
-    WORD dosibs, done, junk;
-    GRECT t, o;
-    WORD parent, childobj, flags;
+    WORD lastfound, found;
+    WORD junk;
+    GRECT t, o, f;
+    WORD parent, childobj;
     OBJECT *objptr;
 
-    lastfound = NIL;
-
     if (currobj == 0)
         r_set(&o, 0, 0, 0, 0);
     else
@@ -493,52 +537,43 @@ WORD ob_find(OBJECT *tree, WORD currobj, WORD depth, WORD mx, WORD my)
         ob_actxywh(tree, parent, &o);
     }
 
-    done = FALSE;
-    dosibs = FALSE;
+    ob_relxywh(tree, currobj, &t);
+    t.g_x += o.g_x;
+    t.g_y += o.g_y;
 
-    while(!done)
-    {
-        /*
-         * if inside this obj, might be inside a child, so check
-         */
-        ob_relxywh(tree, currobj, &t);
-        t.g_x += o.g_x;
-        t.g_y += o.g_y;
+    objptr = tree + currobj;
+    if (!inside(mx, my, &t) || (objptr->ob_flags & HIDETREE))
+        return NIL;
+    lastfound = currobj;
 
-        objptr = tree + currobj;
-        flags = objptr->ob_flags;
-        if ( (inside(mx, my, &t)) && (!(flags & HIDETREE)) )
-        {
-            lastfound = currobj;
+    /*
+     * if inside this obj, might be inside a child, so check
+     */
+    for ( ; depth > 0; depth--)
+    {
+        o.g_x = t.g_x;
+        o.g_y = t.g_y;
+        found = NIL;
 
-            childobj = objptr->ob_tail;
-            if ((childobj != NIL) && depth)
-            {
-                currobj = childobj;
-                depth--;
-                o.g_x = t.g_x;
-                o.g_y = t.g_y;
-                dosibs = TRUE;
-            }
-            else
-                done = TRUE;
-        }
-        else
+        for (childobj = objptr->ob_head; (childobj != lastfound) && (childobj >= ROOT);
+                                childobj = tree[childobj].ob_next)
         {
-            if (dosibs && (lastfound != NIL))
+            ob_relxywh(tree, childobj, &f);
+            f.g_x += o.g_x;
+            f.g_y += o.g_y;
+            if (inside(mx, my, &f) && !(tree[childobj].ob_flags & HIDETREE))
             {
-                currobj = get_prev(tree, lastfound, currobj);
-                if (currobj == NIL)
-                    done = TRUE;
+                found = childobj;
+                t = f;
             }
-            else
-                done = TRUE;
         }
+
+        if (found == NIL)
+            break;
+        lastfound = found;
+        objptr = tree + found;
     }
 
-    /*
-     * if no one was found, this will return NIL
-     */
     return lastfound;
 }
 
@@ -0,0 +1,142 @@
+/*
+ * gemprof.c - AES redraw statistics
+ *
+ * Copyright 2018 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#include "config.h"
+#include "portab.h"
+#include "struct.h"
+#include "obdefs.h"
+#include "gemlib.h"
+#include "basepage.h"
+
+#include "geminit.h"
+#include "gemprof.h"
+#include "rectfunc.h"
+
+#include "string.h"
+#include "../bios/tosvars.h"
+#include "../bios/cookie.h"
+
+#if CONF_WITH_AES_PROFILE
+
+/*
+ * When enabled, the AES collects statistics about the WM_REDRAW messages
+ * that it sends, both for each window and for each process that owns a
+ * window:
+ *  . the number of messages, and how many of these were merged with a
+ *    message that was already in the queue (see q_merge())
+ *  . the number of owner rectangles within the redraw areas, i.e. the
+ *    number of rectangles that the application must redraw
+ *  . the number of pixels within the redraw areas
+ *  . for processes, the time from the first WM_REDRAW message that the
+ *    process has not yet handled until it next ends a wind_update()
+ *
+ * The statistics are found via the COOKIE_EAPR cookie, which points to an
+ * AesProfile structure.  A program sets 'enabled' to start collecting,
+ * and may clear the tables at any time.
+ */
+
+static AesRedrawProfile prof_win[NUM_WIN];
+static AesRedrawProfile prof_proc[NUM_ACCS+2];
+static ULONG pending[NUM_ACCS+2];       /* when the first WM_REDRAW was sent */
+static AesProfile profile;
+
+
+/*
+ *  Set up the statistics tables & make them visible via the cookie jar
+ */
+void prof_init(void)
+{
+    if (!profile.win)           /* first time */
+    {
+        profile.win = prof_win;
+        profile.proc = prof_proc;
+        cookie_add(COOKIE_EAPR, (long)&profile);
+    }
+
+    /* handles & process ids are reused by a new AES */
+    profile.nwindows = num_wins;
+    profile.nprocs = totpds;
+    memset(prof_win, 0, sizeof(prof_win));
+    memset(prof_proc, 0, sizeof(prof_proc));
+    memset(pending, 0, sizeof(pending));
+}
+
+
+/*
+ *  Called when a WM_REDRAW message for area 'pt' of window 'w_handle'
+ *  is sent to process 'ppd'
+ */
+void prof_redraw(WORD w_handle, AESPD *ppd, const GRECT *pt)
+{
+    AesRedrawProfile *w, *p;
+    ORECT *po;
+    GRECT t;
+    WORD rects;
+    ULONG pixels;
+
+    if (!profile.enabled)
+        return;
+
+    for (po = D.w_win[w_handle].w_rlist, rects = 0; po; po = po->o_link)
+    {
+        rc_copy(pt, &t);
+        if (rc_intersect(&po->o_gr, &t))
+            rects++;
+    }
+    pixels = (ULONG)pt->g_w * pt->g_h;
+
+    w = &prof_win[w_handle];
+    w->redraws++;
+    w->rects += rects;
+    w->pixels += pixels;
+
+    p = &prof_proc[ppd->p_pid];
+    p->redraws++;
+    p->rects += rects;
+    p->pixels += pixels;
+    if (!pending[ppd->p_pid])
+        pending[ppd->p_pid] = hz_200 | 1;   /* 0 means none pending */
+}
+
+
+/*
+ *  Called when a WM_REDRAW message for window 'w_handle' is merged with
+ *  a message already queued for process 'ppd'
+ *
+ *  the message may come from appl_write(), so the handle is checked
+ */
+void prof_merged(WORD w_handle, AESPD *ppd)
+{
+    if (!profile.enabled)
+        return;
+
+    if ((w_handle >= 0) && (w_handle < NUM_WIN))
+        prof_win[w_handle].merged++;
+    prof_proc[ppd->p_pid].merged++;
+}
+
+
+/*
+ *  Called when the current process ends a wind_update(BEG_UPDATE)
+ */
+void prof_endupdate(void)
+{
+    AesRedrawProfile *p;
+    WORD pid = rlr->p_pid;
+
+    if (!profile.enabled || !pending[pid])
+        return;
+
+    p = &prof_proc[pid];
+    p->updates++;
+    p->time += (hz_200 | 1) - pending[pid];
+    pending[pid] = 0;
+}
+
+#endif /* CONF_WITH_AES_PROFILE */
@@ -0,0 +1,42 @@
+/*
+ * EmuTOS AES
+ *
+ * Copyright (C) 2018 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#ifndef GEMPROF_H
+#define GEMPROF_H
+
+#if CONF_WITH_AES_PROFILE
+
+/* redraw statistics, for one window or for one process */
+typedef struct {
+    ULONG redraws;              /* WM_REDRAW messages sent */
+    ULONG merged;               /* of which merged with a queued message */
+    ULONG rects;                /* owner rectangles within the redraw areas */
+    ULONG pixels;               /* pixels within the redraw areas */
+    ULONG updates;              /* redraws timed, see below */
+    ULONG time;                 /* total time from WM_REDRAW to END_UPDATE, */
+                                /*  in 200Hz ticks                          */
+} AesRedrawProfile;
+
+/* pointed to by the COOKIE_EAPR cookie */
+typedef struct {
+    WORD enabled;               /* set non-zero to collect statistics */
+    WORD nwindows;              /* number of entries in win[] */
+    WORD nprocs;                /* number of entries in proc[] */
+    AesRedrawProfile *win;      /* indexed by window handle */
+    AesRedrawProfile *proc;     /* indexed by AES process id */
+} AesProfile;
+
+void prof_init(void);
+void prof_redraw(WORD w_handle, AESPD *ppd, const GRECT *pt);
+void prof_merged(WORD w_handle, AESPD *ppd);
+void prof_endupdate(void);
+
+#endif
+
+#endif
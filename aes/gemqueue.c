@@ -26,60 +26,148 @@
 #include "rectfunc.h"
 #include "gemasync.h"
 #include "gemqueue.h"
+#include "gemprof.h"
 
 
 
-static void doq(WORD donq, AESPD *p, QPB *m)
+/*
+ * Each process's message queue is a ring buffer of QUEUE_SIZE bytes:
+ * p_qhead is the offset of the first byte in p_queue[], and p_qindex
+ * is the number of bytes in the queue.
+ */
+#define MSG_SIZE    16          /* size of a standard message */
+
+
+/*
+ *  Return the offset in the queue that is 'n' bytes after 'index'
+ */
+static WORD q_offset(WORD index, WORD n)
 {
-    WORD n, index;
-    WORD *om, *nm;
+    index += n;
+    if (index >= QUEUE_SIZE)
+        index -= QUEUE_SIZE;
 
-    n = m->qpb_cnt;
-    if (donq)
+    return index;
+}
+
+
+/*
+ *  Copy to or from the queue, starting at 'index'
+ */
+static void q_copyin(AESPD *p, WORD index, const char *buf, WORD n)
+{
+    WORD len = QUEUE_SIZE - index;
+
+    if (n > len)
     {
-        memcpy(p->p_qaddr+p->p_qindex, (char *)m->qpb_buf, n);
-        /*
-         * if it's a redraw msg, try to find a matching msg and
-         * union the redraw rectangles together
-         */
-        nm = (WORD *) &p->p_queue[p->p_qindex];
-        if ((nm[0] == WM_REDRAW) || (nm[0] == WM_ARROWED) || (nm[0] == WM_HSLID) || (nm[0] == WM_VSLID))
+        memcpy(p->p_queue+index, buf, len);
+        buf += len;
+        n -= len;
+        index = 0;
+    }
+    memcpy(p->p_queue+index, buf, n);
+}
+
+static void q_copyout(AESPD *p, WORD index, char *buf, WORD n)
+{
+    WORD len = QUEUE_SIZE - index;
+
+    if (n > len)
+    {
+        memcpy(buf, p->p_queue+index, len);
+        buf += len;
+        n -= len;
+        index = 0;
+    }
+    memcpy(buf, p->p_queue+index, n);
+}
+
+
+/*
+ *  Remove 'n' bytes from the front of the queue
+ */
+void aq_read(AESPD *p, void *buf, WORD n)
+{
+    if (n > p->p_qindex)
+        n = p->p_qindex;
+
+    q_copyout(p, p->p_qhead, buf, n);
+    p->p_qindex -= n;
+    p->p_qhead = p->p_qindex ? q_offset(p->p_qhead, n) : 0;
+}
+
+
+/*
+ *  Try to merge a new message with one that is already queued
+ *
+ *  a redraw message is merged with a queued redraw message for the same
+ *  window by taking the union of the rectangles.  for the other window
+ *  messages below, only the most recent one matters, so the new message
+ *  replaces a queued one of the same type for the same window.
+ *
+ *  returns TRUE if the message was merged
+ */
+static BOOL q_merge(AESPD *p, const WORD *nm)
+{
+    WORD om[MSG_SIZE/sizeof(WORD)];
+    WORD index, left, len;
+
+    switch(nm[0])
+    {
+    case WM_REDRAW:
+    case WM_ARROWED:
+    case WM_HSLID:
+    case WM_VSLID:
+    case WM_SIZED:
+    case WM_MOVED:
+        break;
+    default:
+        return FALSE;
+    }
+
+    for (index = p->p_qhead, left = p->p_qindex; left >= MSG_SIZE; left -= len)
+    {
+        q_copyout(p, index, (char *)om, MSG_SIZE);
+        len = MSG_SIZE + om[2];
+        if ((om[2] < 0) || (len > left))
+            break;              /* not a message: give up */
+        if ((om[0] == nm[0]) && (om[2] == 0) && (om[3] == nm[3]))
         {
-            index = 0;
-            while ((index < p->p_qindex) && n)
+            if (nm[0] == WM_REDRAW)
             {
-                om = (WORD *) &p->p_queue[index];
-                /* if redraw and same handle then union */
-                if ((om[0] == WM_REDRAW) && (nm[3] == om[3]))
-                {
-                    rc_union((GRECT *)&nm[4], (GRECT *)&om[4]);  /* FIXME: Ugly pointer typecasting */
-                    n = 0;
-                }
-                else
-                {
-                    /*
-                     * if another arrow command then copy over with new msg
-                     * else add in length and get next msg
-                     */
-                    if (om[0] == WM_ARROWED)
-                    {
-                        memcpy(om, nm, 16);
-                        n = 0;
-                    }
-                    else
-                        index += om[2] + 16;
-                }
+                rc_union((const GRECT *)&nm[4], (GRECT *)&om[4]);
+#if CONF_WITH_AES_PROFILE
+                prof_merged(nm[3], p);
+#endif
             }
+            else
+                memcpy(om, nm, MSG_SIZE);
+            q_copyin(p, index, (char *)om, MSG_SIZE);
+            return TRUE;
         }
-        p->p_qindex += n;
+        index = q_offset(index, len);
     }
-    else
+
+    return FALSE;
+}
+
+
+static void doq(WORD donq, AESPD *p, QPB *m)
+{
+    WORD n;
+    char *buf;
+
+    n = m->qpb_cnt;
+    buf = (char *)m->qpb_buf;
+    if (donq)
     {
-        memcpy((char *)m->qpb_buf, p->p_qaddr, n);
-        p->p_qindex -= n;
-        if (p->p_qindex)
-            memcpy(p->p_qaddr, p->p_qaddr+n, p->p_qindex);
+        if ((n == MSG_SIZE) && q_merge(p, (WORD *)buf))
+            return;
+        q_copyin(p, q_offset(p->p_qhead, p->p_qindex), buf, n);
+        p->p_qindex += n;
     }
+    else
+        aq_read(p, buf, n);
 }
 
 
@@ -10,6 +10,7 @@
 #ifndef GEMQUEUE_H
 #define GEMQUEUE_H
 
+void aq_read(AESPD *p, void *buf, WORD n);
 void aqueue(WORD isqwrite, EVB *e, LONG lm);
 
 #endif
@@ -232,9 +232,9 @@ static void fix_objects(void)
     WORD obtype;
     OBJECT *obj;
 
-    for (ii = 0; ii < rs_hdr->rsh_nobs; ii++)
+    obj = (OBJECT *)get_addr(R_OBJECT, 0);
+    for (ii = 0; ii < rs_hdr->rsh_nobs; ii++, obj++)
     {
-        obj = (OBJECT *)get_addr(R_OBJECT, ii);
         rs_obfix(obj, 0);
         obtype = obj->ob_type & 0x00ff;
         if ((obtype != G_BOX) && (obtype != G_IBOX) && (obtype != G_BOXCHAR))
@@ -243,18 +243,16 @@ static void fix_objects(void)
 }
 
 
-static void fix_nptrs(WORD cnt, WORD type)
+/*
+ *  Fix up 'cnt' pointers of the given type: these are 'size' bytes
+ *  apart, in an array of structures or of pointers
+ */
+static void fix_nptrs(WORD cnt, WORD type, WORD size)
 {
-    WORD i;
-
-    for (i = 0; i < cnt; i++)
-        fix_long(get_addr(type, i));
-}
+    char *p;
 
-
-static BOOL fix_ptr(WORD type, WORD index)
-{
-    return fix_long(get_addr(type, index));
+    for (p = get_addr(type, 0); cnt > 0; cnt--, p += size)
+        fix_long((LONG *)p);
 }
 
 
@@ -263,14 +261,14 @@ static void fix_tedinfo(void)
     WORD ii;
     TEDINFO *ted;
 
-    for (ii = 0; ii < rs_hdr->rsh_nted; ii++)
+    ted = (TEDINFO *)get_addr(R_TEDINFO, 0);
+    for (ii = 0; ii < rs_hdr->rsh_nted; ii++, ted++)
     {
-        ted = (TEDINFO *)get_addr(R_TEDINFO, ii);
-        if (fix_ptr(R_TEPTEXT, ii))
+        if (fix_long((LONG *)&ted->te_ptext))
             ted->te_txtlen = strlen(ted->te_ptext) + 1;
-        if (fix_ptr(R_TEPTMPLT, ii))
+        if (fix_long((LONG *)&ted->te_ptmplt))
             ted->te_tmplen = strlen(ted->te_ptmplt) + 1;
-        fix_ptr(R_TEPVALID, ii);
+        fix_long((LONG *)&ted->te_pvalid);
     }
 }
 
@@ -348,15 +346,18 @@ static WORD rs_readit(AESGLOBAL *pglobal,UWORD fd)
 
     /* get size of resource & allocate memory */
     rslsize = hdr_buff.rsh_rssize;
+    if (rslsize < sizeof(hdr_buff))
+        return FALSE;
     rs_hdr = (RSHDR *)dos_alloc_anyram(rslsize);
     if (!rs_hdr)
         return FALSE;
 
-    /* read it all in */
-    if (dos_lseek(fd, 0, 0x0L) < 0L)    /* mode 0: absolute offset */
-        return FALSE;
-    if (dos_read(fd, rslsize, rs_hdr) != rslsize)
+    /* we already have the header, so read in the rest */
+    memcpy(rs_hdr, &hdr_buff, sizeof(hdr_buff));
+    rslsize -= sizeof(hdr_buff);
+    if (dos_read(fd, rslsize, rs_hdr+1) != rslsize)
         return FALSE;           /* error or short read */
+    rslsize += sizeof(hdr_buff);
 
     /* init global */
     rs_global = pglobal;
@@ -370,12 +371,12 @@ static WORD rs_readit(AESGLOBAL *pglobal,UWORD fd)
     fix_trindex();
     fix_tedinfo();
     ibcnt = rs_hdr->rsh_nib;
-    fix_nptrs(ibcnt, R_IBPMASK);
-    fix_nptrs(ibcnt, R_IBPDATA);
-    fix_nptrs(ibcnt, R_IBPTEXT);
-    fix_nptrs(rs_hdr->rsh_nbb, R_BIPDATA);
-    fix_nptrs(rs_hdr->rsh_nstring, R_FRSTR);
-    fix_nptrs(rs_hdr->rsh_nimages, R_FRIMG);
+    fix_nptrs(ibcnt, R_IBPMASK, sizeof(ICONBLK));
+    fix_nptrs(ibcnt, R_IBPDATA, sizeof(ICONBLK));
+    fix_nptrs(ibcnt, R_IBPTEXT, sizeof(ICONBLK));
+    fix_nptrs(rs_hdr->rsh_nbb, R_BIPDATA, sizeof(BITBLK));
+    fix_nptrs(rs_hdr->rsh_nstring, R_FRSTR, sizeof(LONG));
+    fix_nptrs(rs_hdr->rsh_nimages, R_FRIMG, sizeof(LONG));
 
     return TRUE;
 }
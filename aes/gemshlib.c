@@ -62,7 +62,7 @@
 
 static char shelbuf[SIZE_AFILE];        /* AES shell buffer */
 
-GLOBAL SHELL sh[NUM_PDS];
+GLOBAL SHELL *sh;                       /* one per process, allocated at startup */
 
 static char sh_apdir[LEN_ZPATH];        /* holds directory of applications to be */
                                         /* run from desktop.  GEMDOS resets dir  */
@@ -644,8 +644,7 @@ static WORD sh_ldapp(SHELL *psh)
         {
             KDEBUG(("sh_ldapp: appl_init() without appl_exit()\n"));
             mn_clsda();
-            if (rlr->p_qindex)
-                ap_rdwr(MU_MESAG, rlr, rlr->p_qindex, (WORD *)D.g_valstr);
+            ap_flush();
             rlr->p_flags &= ~AP_OPEN;
         }
 
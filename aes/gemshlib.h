@@ -10,7 +10,7 @@
 #ifndef GEMSHLIB_H
 #define GEMSHLIB_H
 
-extern SHELL    sh[];
+extern SHELL    *sh;
 
 extern char     *ad_stail;
 
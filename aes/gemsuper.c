@@ -295,7 +295,7 @@ static UWORD crysbind(WORD opcode, AESGLOBAL *pglobal, WORD control[], WORD int_
         if (GR_MNUMBER > USER_DEF)
         {
             if (GR_MNUMBER == M_OFF)
-                gsx_moff();
+                gsx_mhide();
             if (GR_MNUMBER == M_ON)
                 gsx_mon();
             break;
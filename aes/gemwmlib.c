@@ -28,11 +28,13 @@
 #include "gemflag.h"
 #include "gemoblib.h"
 #include "gemwrect.h"
+#include "gemprof.h"
 #include "geminit.h"
 #include "gemfmlib.h"
 #include "gemevlib.h"
 #include "gemwmlib.h"
 #include "gemgsxif.h"
+#include "gemgraf.h"
 #include "gemobjop.h"
 #include "gemctrl.h"
 #include "gem_rsc.h"
@@ -44,8 +46,6 @@
 /*
  *  defines
  */
-#define NUM_MWIN NUM_WIN
-
 #define XFULL   0
 #define YFULL   gl_hbox
 #define WFULL   gl_width
@@ -80,7 +80,7 @@ GLOBAL OBJECT   *gl_awind;
 static OBJECT *gl_newdesk;      /* current desktop background pattern */
 static WORD gl_newroot;         /* current object within gl_newdesk   */
 
-static OBJECT W_TREE[NUM_MWIN];
+#define W_TREE  D.w_tree         /* window extent objects */
 static OBJECT W_ACTIVE[NUM_ELEM];
 
 
@@ -254,6 +254,10 @@ static void w_hvassign(WORD isvert, WORD parent, WORD obj, WORD vx, WORD vy,
 }
 
 
+#if CONF_WITH_VDI_EXTENSIONS
+static GRECT walk_region[MAX_REGION_RECTS];
+#endif
+
 /*
  *  Walk the list and draw the parts of the window tree owned by this window
  */
@@ -261,6 +265,9 @@ static void do_walk(WORD wh, OBJECT *tree, WORD obj, WORD depth, GRECT *pc)
 {
     ORECT   *po;
     GRECT   t;
+#if CONF_WITH_VDI_EXTENSIONS
+    WORD    n;
+#endif
 
     if (wh == NIL)
         return;
@@ -271,6 +278,30 @@ static void do_walk(WORD wh, OBJECT *tree, WORD obj, WORD depth, GRECT *pc)
     else
         pc = &gl_rfull;
 
+#if CONF_WITH_VDI_EXTENSIONS
+    /*
+     * if possible, clip to all the visible rectangles at once & draw
+     * the tree just once.  afterwards, the clip is set as it would be
+     * by the loop below.
+     */
+    for (po = D.w_win[wh].w_rlist, n = 0; po; po = po->o_link)
+    {
+        rc_copy(&po->o_gr, &t);
+        if (rc_intersect(pc, &t))
+        {
+            if (n >= MAX_REGION_RECTS)
+                break;
+            rc_copy(&t, &walk_region[n++]);
+        }
+    }
+    if (!po && (n > 1) && gsx_sregion(walk_region, n))
+    {
+        ob_draw(tree, obj, depth);
+        gsx_sclip(&walk_region[n-1]);
+        return;
+    }
+#endif
+
     /* walk owner rectangle list */
     for (po = D.w_win[wh].w_rlist; po; po = po->o_link)
     {
@@ -604,97 +635,84 @@ static void w_redraw(WORD w_handle, GRECT *pt)
         {
             /* intersect redraw rect with union of owner rects */
             if (rc_intersect(&d, &t))
+            {
+#if CONF_WITH_AES_PROFILE
+                prof_redraw(w_handle, ppd, &t);
+#endif
                 ap_sendmsg(wind_msg, WM_REDRAW, ppd, w_handle, t.g_x, t.g_y, t.g_w, t.g_h);
+            }
         }
     }
 }
 
 
 /*
- *  Routine to fix rectangles in preparation for a source to destination
- *  blit.  If the source is at -1, then the source and destination left
- *  fringes need to be realigned.
+ *  Redraw the part of the top window 'w_handle' that lies within 'pt'
  */
-static WORD w_mvfix(GRECT *ps, GRECT *pd)
+static void w_mvdraw(WORD w_handle, GRECT *pt)
 {
-    WORD tmpsx;
-
-    tmpsx = ps->g_x;
-    rc_intersect(&gl_rfull, ps);
-    if (tmpsx == -1)
-    {
-        pd->g_x++;
-        pd->g_w--;
-        return TRUE;
-    }
+    if ((pt->g_w <= 0) || (pt->g_h <= 0))
+        return;
 
-    return FALSE;
+    gsx_sclip(pt);
+    w_cpwalk(w_handle, 0, MAX_DEPTH, FALSE);
+    w_redraw(w_handle, pt);
 }
 
 
 /*
- *  Call to move top window.  This involves BLTing the window if none
- *  of it that is partially off the screen needs to be redrawn, else
- *  the whole desktop is just updated.  All uncovered portions of the
- *  desktop are redrawn by later calling w_update.
+ *  Call to move top window.  As much of the window as possible is
+ *  BLTed from its old position: only the parts of the window that were
+ *  off the screen & are now visible are redrawn (at most four bands
+ *  around the area BLTed to).  All uncovered portions of the desktop
+ *  and other windows are redrawn by later calling w_update, using the
+ *  visible part of the old position that is returned in prc.
  */
 static WORD w_move(WORD w_handle, WORD *pstop, GRECT *prc)
 {
-    GRECT   s;      /* source */
-    GRECT   d;      /* destination */
-    GRECT   *pc;
-    WORD    sminus1, dminus1;
+    GRECT   s;      /* visible part of source */
+    GRECT   d;      /* visible part of destination */
+    GRECT   b;      /* area BLTed to */
+    GRECT   t;
+    WORD    dx, dy;
 
     w_getsize(WS_PREV, w_handle, &s);
     s.g_w += DROP_SHADOW_SIZE;
     s.g_h += DROP_SHADOW_SIZE;
     w_getsize(WS_TRUE, w_handle, &d);
+    dx = d.g_x - s.g_x;
+    dy = d.g_y - s.g_y;
 
-    /* set flags for when part of the source is off the screen */
-    if ( ((s.g_x+s.g_w > gl_width) && (d.g_x < s.g_x))  ||
-         ((s.g_y+s.g_h > gl_height) && (d.g_y < s.g_y)) )
-    {
-        rc_union(&s, &d);
-        *pstop = DESKWH;
-    }
-    else
-    {
-        *pstop = w_handle;
-    }
-
-    /* intersect with full screen and align fringes if -1 xpos */
-    sminus1 = w_mvfix(&s, &d);
-    dminus1 = w_mvfix(&d, &s);
+    if (!rc_intersect(&gl_rfull, &s))
+        s.g_w = s.g_h = 0;
+    if (!rc_intersect(&gl_rfull, &d))
+        d.g_w = d.g_h = 0;
 
-    /* blit what we can */
-    if (*pstop == w_handle)
+    /* blit the part of the source that will be visible at the destination */
+    r_set(&b, s.g_x+dx, s.g_y+dy, s.g_w, s.g_h);
+    if (rc_intersect(&d, &b))
     {
         gsx_sclip(&gl_rfull);
-        bb_screen(S_ONLY, s.g_x, s.g_y, d.g_x, d.g_y, s.g_w, s.g_h);
-        /* cleanup left edge */
-        if (sminus1 != dminus1)
-        {
-            if (dminus1)
-                s.g_x--;
-            if (sminus1)
-            {
-                d.g_x--;
-                d.g_w = 1;
-                gsx_sclip(&d);
-                w_cpwalk(gl_wtop, 0, 0, FALSE);
-            }
-        }
-        pc = &s;
+        bb_screen(S_ONLY, b.g_x-dx, b.g_y-dy, b.g_x, b.g_y, b.g_w, b.g_h);
     }
     else
-    {
-        pc = &d;
-    }
+        r_set(&b, d.g_x, d.g_y, 0, 0);
+
+    /* redraw the rest of the destination: top, bottom, left, right */
+    r_set(&t, d.g_x, d.g_y, d.g_w, b.g_y-d.g_y);
+    w_mvdraw(w_handle, &t);
+    r_set(&t, d.g_x, b.g_y+b.g_h, d.g_w, d.g_y+d.g_h-b.g_y-b.g_h);
+    w_mvdraw(w_handle, &t);
+    r_set(&t, d.g_x, b.g_y, b.g_x-d.g_x, b.g_h);
+    w_mvdraw(w_handle, &t);
+    r_set(&t, b.g_x+b.g_w, b.g_y, d.g_x+d.g_w-b.g_x-b.g_w, b.g_h);
+    w_mvdraw(w_handle, &t);
 
     /* clean up the rest by returning clip rect */
-    rc_copy(pc, prc);
+    rc_copy(&s, prc);
+    *pstop = w_handle;
 
-    return (*pstop == w_handle);
+    return TRUE;
 }
 
 
@@ -760,7 +778,7 @@ void w_update(WORD bottom, GRECT *pt, WORD top, BOOL moved)
  */
 static void draw_change(WORD w_handle, GRECT *pt)
 {
-    GRECT   c, pprev;
+    GRECT   c, old, pprev;
     GRECT   *pw;
     WORD    start, stop;
     BOOL    moved;
@@ -769,6 +787,7 @@ static void draw_change(WORD w_handle, GRECT *pt)
     wasclr = !(D.w_win[w_handle].w_flags & VF_BROKEN);
 
     /* save old size */
+    w_getsize(WS_TRUE, w_handle, &old);
     w_getsize(WS_CURR, w_handle, &c);
     w_setsize(WS_PREV, w_handle, &c);
 
@@ -780,7 +799,7 @@ static void draw_change(WORD w_handle, GRECT *pt)
                 &pw->g_x, &pw->g_y, &pw->g_w, &pw->g_h);
 
     /* update rectangle lists */
-    everyobj(gl_wtree, ROOT, NIL, (EVERYOBJ_CALLBACK)newrect, 0, 0, MAX_DEPTH);
+    newrect(gl_wtree, w_handle, &old);
 
     /* remember oldtop & set new one */
     oldtop = gl_wtop;
@@ -954,9 +973,9 @@ void wm_start(void)
     or_start();
 
     /* init window extent objects */
-    memset(&W_TREE[ROOT], 0, NUM_MWIN * sizeof(OBJECT));
-    w_nilit(NUM_MWIN, &W_TREE[ROOT]);
-    for (i = 0; i < NUM_MWIN; i++)
+    memset(&W_TREE[ROOT], 0, num_wins * sizeof(OBJECT));
+    w_nilit(num_wins, &W_TREE[ROOT]);
+    for (i = 0; i < num_wins; i++)
     {
         D.w_win[i].w_flags = 0x0;
         D.w_win[i].w_rlist = NULL;
@@ -978,8 +997,11 @@ void wm_start(void)
 
     /* init rectangle list */
     D.w_win[0].w_rlist = po = get_orect();
-    po->o_link = NULL;
-    r_set(&po->o_gr, XFULL, YFULL, WFULL, HFULL);
+    if (po)
+    {
+        po->o_link = NULL;
+        r_set(&po->o_gr, XFULL, YFULL, WFULL, HFULL);
+    }
     w_setup(ppd, DESKWH, NONE);
     w_setsize(WS_CURR, DESKWH, &gl_rscreen);
     w_setsize(WS_PREV, DESKWH, &gl_rscreen);
@@ -1009,9 +1031,9 @@ WORD wm_create(WORD kind, GRECT *pt)
 {
     WORD i;
 
-    for (i = 0; (i < NUM_WIN) && (D.w_win[i].w_flags & VF_INUSE); i++)
+    for (i = 0; (i < num_wins) && (D.w_win[i].w_flags & VF_INUSE); i++)
         ;
-    if (i < NUM_WIN)
+    if (i < num_wins)
     {
         w_setup(rlr, i, kind);
         w_setsize(WS_CURR, i, &gl_rzero);
@@ -1075,7 +1097,7 @@ void wm_close(WORD w_handle)
  */
 void wm_delete(WORD w_handle)
 {
-    newrect(gl_wtree, w_handle);      /* give back recs. */
+    delrect(w_handle);                /* give back recs. */
     w_setsize(WS_CURR, w_handle, &gl_rscreen);
     w_setsize(WS_PREV, w_handle, &gl_rscreen);
     w_setsize(WS_FULL, w_handle, &gl_rfull);
@@ -1280,7 +1302,12 @@ void wm_update(WORD beg_update)
 
         }
         else
+        {
+#if CONF_WITH_AES_PROFILE
+            prof_endupdate();
+#endif
             unsync(&wind_spb);
+        }
     }
     else
     {
@@ -1347,7 +1374,7 @@ void wm_new(void)
         wm_update(END_UPDATE);
 
     /* Delete windows: */
-    for (wh = 1; wh < NUM_WIN; wh++)
+    for (wh = 1; wh < num_wins; wh++)
     {
         if (D.w_win[wh].w_flags & VF_INTREE)
             wm_close(wh);
@@ -24,6 +24,7 @@
 #include "gemwmlib.h"
 #include "geminit.h"
 #include "gemwrect.h"
+#include "rectfunc.h"
 
 
 #define TOP     0
@@ -36,12 +37,21 @@ static ORECT *rul;
 static ORECT gl_mkrect;
 
 
+/*
+ *  The owner rectangles are allocated at startup (see gem_main()), and
+ *  kept on a free list.  If the pool does become exhausted, windows are
+ *  left with fewer rectangles than they should have: they may then not
+ *  be redrawn completely, but nothing is drawn over the windows on top.
+ */
 void or_start(void)
 {
     WORD i;
 
     rul = NULL;
-    for (i = 0; i < NUM_ORECT; i++)
+    if (!D.g_olist)
+        return;
+
+    for (i = 0; i < num_wins*ORECTS_PER_WIN; i++)
     {
         D.g_olist[i].o_link = rul;
         rul = &D.g_olist[i];
@@ -60,6 +70,37 @@ ORECT *get_orect(void)
 }
 
 
+/*
+ *  Return a list of orects to the free list
+ */
+static void or_free(ORECT *r0)
+{
+    ORECT   *r;
+
+    if (!r0)
+        return;
+
+    for (r = r0; r->o_link; r = r->o_link)
+        ;
+    r->o_link = rul;
+    rul = r0;
+}
+
+
+/*
+ *  Return TRUE iff there are at least n free orects
+ */
+static BOOL or_avail(WORD n)
+{
+    ORECT   *r;
+
+    for (r = rul; r && n; r = r->o_link)
+        n--;
+
+    return (n == 0);
+}
+
+
 static ORECT *mkpiece(WORD tlrb, ORECT *new, ORECT *old)
 {
     ORECT *rl;
@@ -114,10 +155,17 @@ static ORECT *brkrct(ORECT *new, ORECT *r, ORECT *p)
         have_piece[RIGHT] = ((new->o_gr.g_x + new->o_gr.g_w) < (r->o_gr.g_x + r->o_gr.g_w));
         have_piece[BOTTOM] = ((new->o_gr.g_y + new->o_gr.g_h) < (r->o_gr.g_y + r->o_gr.g_h));
 
-        for (i = 0; i < 4; i++)
+        /*
+         * if we can't get enough orects for the pieces, we drop the
+         * whole rectangle, rather than risk drawing over the new one
+         */
+        if (or_avail(have_piece[TOP] + have_piece[LEFT] + have_piece[RIGHT] + have_piece[BOTTOM]))
         {
-            if (have_piece[i])
-                p = (p->o_link = mkpiece(i, new, r));
+            for (i = 0; i < 4; i++)
+            {
+                if (have_piece[i])
+                    p = (p->o_link = mkpiece(i, new, r));
+            }
         }
 
         /* take out the old guy */
@@ -161,25 +209,64 @@ static void mkrect(OBJECT *tree, WORD wh)
 }
 
 
-void newrect(OBJECT *tree, WORD wh)
+/*
+ *  Merge rectangles in a window's list that together form a single
+ *  rectangle, i.e. that have the same x & width and are vertically
+ *  adjacent, or have the same y & height and are horizontally adjacent
+ */
+static BOOL adjacent(const GRECT *a, const GRECT *b)
+{
+    if ((a->g_x == b->g_x) && (a->g_w == b->g_w))
+        return (a->g_y + a->g_h == b->g_y) || (b->g_y + b->g_h == a->g_y);
+
+    if ((a->g_y == b->g_y) && (a->g_h == b->g_h))
+        return (a->g_x + a->g_w == b->g_x) || (b->g_x + b->g_w == a->g_x);
+
+    return FALSE;
+}
+
+
+static void mergerects(WINDOW *pwin)
+{
+    ORECT   *r, *p, *q;
+    BOOL    merged;
+
+    do
+    {
+        merged = FALSE;
+        for (r = pwin->w_rlist; r; r = r->o_link)
+        {
+            for (p = r, q = r->o_link; q; p = q, q = q->o_link)
+            {
+                if (adjacent(&r->o_gr, &q->o_gr))
+                {
+                    rc_union(&q->o_gr, &r->o_gr);
+                    p->o_link = q->o_link;
+                    q->o_link = rul;
+                    rul = q;
+                    q = p;
+                    merged = TRUE;
+                }
+            }
+        }
+    } while (merged);
+}
+
+
+/*
+ *  Rebuild the rectangle list of a window: start with its true size,
+ *  then break it up with each of the windows above it
+ */
+static void rebuild(OBJECT *tree, WORD wh)
 {
     WINDOW  *pwin;
-    ORECT   *r, *new;
-    ORECT   *r0;
+    ORECT   *new;
+    WORD    above;
 
     pwin = &D.w_win[wh];
-    r0 = pwin->w_rlist;
 
     /* dump rectangle list */
-    if (r0)
-    {
-        for (r = r0; r->o_link; r = r->o_link)
-            ;
-        r->o_link = rul;
-        rul = r0;
-    }
-
-    /* zero the rectangle list */
+    or_free(pwin->w_rlist);
     pwin->w_rlist = NULL;
 
     /* start out with no broken rectangles */
@@ -190,15 +277,76 @@ void newrect(OBJECT *tree, WORD wh)
     if (!(gl_mkrect.o_gr.g_w && gl_mkrect.o_gr.g_h))
         return;
 
+    /* get an orect in this window's list */
+    new = get_orect();
+    if (!new)
+        return;
+    new->o_link = NULL;
+    rc_copy(&gl_mkrect.o_gr, &new->o_gr);
+    pwin->w_rlist = new;
+
     /* init. a global orect for use during mkrect calls */
     gl_mkrect.o_link = NULL;
 
-    /* break other window's rects with our current rect */
-    everyobj(tree, ROOT, wh, (EVERYOBJ_CALLBACK)mkrect, 0, 0, MAX_DEPTH);
+    /* break our rects with the rects of the windows above us */
+    above = (wh == ROOT) ? tree[ROOT].ob_head : tree[wh].ob_next;
+    for ( ; (above != NIL) && (above != ROOT); above = tree[above].ob_next)
+    {
+        w_getsize(WS_TRUE, above, &gl_mkrect.o_gr);
+        if (gl_mkrect.o_gr.g_w && gl_mkrect.o_gr.g_h)
+            mkrect(tree, wh);
+    }
+
+    mergerects(pwin);
+}
 
-    /* get an orect in this window's list */
-    new = get_orect();
-    new->o_link  = NULL;
-    w_getsize(WS_TRUE, wh, &new->o_gr);
-    pwin->w_rlist = new;
+
+/*
+ *  Return TRUE iff window wh overlaps the specified area
+ */
+static BOOL overlaps(WORD wh, const GRECT *pt)
+{
+    GRECT   t;
+
+    w_getsize(WS_TRUE, wh, &t);
+
+    return rc_intersect(pt, &t);
+}
+
+
+/*
+ *  Update the rectangle lists after window wh has been opened, closed,
+ *  moved, sized or topped.  pold is the area that it occupied before
+ *  (including the drop shadow).
+ *
+ *  Only the windows that overlap the old or new area of wh can have
+ *  gained or lost visible parts, so only their lists (and that of the
+ *  desktop, which overlaps everything) are rebuilt.
+ */
+void newrect(OBJECT *tree, WORD wh, const GRECT *pold)
+{
+    GRECT   new;
+    WORD    i;
+
+    w_getsize(WS_TRUE, wh, &new);
+
+    rebuild(tree, wh);
+    if (wh != ROOT)
+        rebuild(tree, ROOT);
+
+    for (i = tree[ROOT].ob_head; (i != NIL) && (i != ROOT); i = tree[i].ob_next)
+    {
+        if ((i != wh) && (overlaps(i, pold) || overlaps(i, &new)))
+            rebuild(tree, i);
+    }
+}
+
+
+/*
+ *  Give back the rectangles of a window that is being deleted
+ */
+void delrect(WORD wh)
+{
+    or_free(D.w_win[wh].w_rlist);
+    D.w_win[wh].w_rlist = NULL;
 }
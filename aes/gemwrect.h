@@ -12,6 +12,7 @@
 
 void or_start(void);
 ORECT *get_orect(void);
-void newrect(OBJECT *tree, WORD wh);
+void newrect(OBJECT *tree, WORD wh, const GRECT *pold);
+void delrect(WORD wh);
 
 #endif
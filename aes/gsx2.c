@@ -1,7 +1,7 @@
 /*
  * gsx2.c - VDI (GSX) bindings
  *
- * Copyright (C) 2014 The EmuTOS development team
+ * Copyright (C) 2014-2018 The EmuTOS development team
  *
  * Authors:
  *  VRI   Vincent Rivière
@@ -14,13 +14,37 @@
 #include "gsx2.h"
 #include "obdefs.h"
 #include "gsxdefs.h"
+#include "funcdef.h"
+#include "gemdosif.h"
+#include "string.h"
 
 VDIPB vdipb;
 
-void gsx2(void)
-{
-    vdipb.contrl = contrl;
+#if CONF_WITH_VDI_EXTENSIONS
+/*
+ * VDI command batching
+ *
+ * Between gsx_batch_begin() and gsx_batch_end(), output & attribute
+ * calls that do not return anything useful to the AES are recorded in
+ * batch_buf[] rather than being sent to the VDI immediately.  They are
+ * sent as a single v_batch() call (see vdi/vdi_main.c for the format)
+ * when the buffer fills up, when any other VDI call is made, or when
+ * gsx_batch_flush() or gsx_batch_end() is called.
+ */
+#define BATCH_SIZE      1024    /* in WORDs */
+#define BATCH_HDR_LEN   9       /* per-command header, in WORDs */
+#define FDB_WORDS       (sizeof(FDB)/sizeof(WORD))
 
+static WORD batch_buf[BATCH_SIZE+1];    /* +1 for terminator */
+static WORD batch_len;          /* number of WORDs used in batch_buf[] */
+static WORD batch_level;        /* nesting level of gsx_batch_begin() */
+static BOOL batch_on;           /* TRUE iff calls are being recorded */
+static WORD batch_contrl[12];
+static WORD batch_intout[1];
+#endif
+
+static void gsx_trap(void)
+{
     __asm__ volatile
     (
         "move.l  %0,d1\n\t"
@@ -31,3 +55,149 @@ void gsx2(void)
     : "d0", "d1", "d2", "a0", "a1", "a2", "memory", "cc"
     );
 }
+
+#if CONF_WITH_VDI_EXTENSIONS
+/*
+ * record the current call in batch_buf[]; returns FALSE if this is
+ * not possible, in which case the call must be made directly
+ */
+static BOOL gsx_record(void)
+{
+    WORD *p, *fdb;
+    WORD len, nfdb, i;
+    LONG_ALIAS *ptr;
+
+    switch(contrl[0])
+    {
+    case POLYLINE:
+    case TEXT:
+    case S_LINE_TYPE:
+    case S_LINE_COLOR:
+    case S_TEXT_COLOR:
+    case S_FILL_STYLE:
+    case S_FILL_INDEX:
+    case S_FILL_COLOR:
+    case SET_WRITING_MODE:
+    case ST_UD_LINE_STYLE:
+    case FILL_RECTANGLE:
+    case SHOW_CUR:
+    case HIDE_CUR:
+        nfdb = 0;
+        break;
+    case TEXT_CLIP:
+        if (contrl[1] > 2)  /* clip region: the caller needs the result */
+            return FALSE;
+        nfdb = 0;
+        break;
+    case COPY_RASTER_FORM:
+    case TRAN_RASTER_FORM:
+        nfdb = 2;       /* the MFDBs may change before the batch is sent */
+        break;
+    default:
+        return FALSE;
+    }
+
+    if (contrl[6] != gl_handle)
+        return FALSE;
+
+    len = BATCH_HDR_LEN + 2*contrl[1] + contrl[3] + nfdb*FDB_WORDS;
+    if (len > BATCH_SIZE)
+        return FALSE;
+    if (batch_len + len > BATCH_SIZE)
+        gsx_batch_flush();
+
+    p = batch_buf + batch_len;
+    *p++ = len;
+    *p++ = contrl[0];
+    *p++ = contrl[1];
+    *p++ = contrl[3];
+    *p++ = contrl[5];
+    memcpy(p, contrl+7, 4*sizeof(WORD));
+    ptr = (LONG_ALIAS *)p;
+    p += 4;
+    memcpy(p, vdipb.ptsin, 2*contrl[1]*sizeof(WORD));
+    p += 2*contrl[1];
+    memcpy(p, vdipb.intin, contrl[3]*sizeof(WORD));
+    p += contrl[3];
+
+    /* copy the MFDBs & point to the copies */
+    for (i = 0; i < nfdb; i++, ptr++)
+    {
+        fdb = (WORD *)*ptr;
+        memcpy(p, fdb, FDB_WORDS*sizeof(WORD));
+        *ptr = (LONG)p;
+        p += FDB_WORDS;
+    }
+
+    batch_len += len;
+
+    return TRUE;
+}
+
+
+/*
+ * send the recorded calls (if any) to the VDI
+ */
+void gsx_batch_flush(void)
+{
+    VDIPB save;
+
+    if (batch_len == 0)
+        return;
+
+    batch_buf[batch_len] = 0;   /* terminate buffer */
+    batch_len = 0;
+
+    save = vdipb;
+    batch_contrl[0] = BATCH_COMMANDS;
+    batch_contrl[1] = 0;
+    batch_contrl[3] = 0;
+    batch_contrl[6] = gl_handle;
+    *(LONG_ALIAS *)(batch_contrl+7) = (LONG)batch_buf;
+    vdipb.contrl = batch_contrl;
+    vdipb.intout = batch_intout;
+    gsx_trap();
+    vdipb = save;
+}
+
+
+/*
+ * start recording calls; calls may be nested
+ *
+ * if the trap #2 vector has been taken over (e.g. by NVDI), the VDI
+ * may not understand v_batch(), so we don't record anything
+ */
+void gsx_batch_begin(void)
+{
+    if (batch_level++ == 0)
+        batch_on = !aestrap_intercepted();
+}
+
+
+/*
+ * stop recording calls & send any recorded ones to the VDI
+ */
+void gsx_batch_end(void)
+{
+    if (--batch_level == 0)
+    {
+        gsx_batch_flush();
+        batch_on = FALSE;
+    }
+}
+#endif
+
+void gsx2(void)
+{
+#if CONF_WITH_VDI_EXTENSIONS
+    if (batch_on)
+    {
+        if (gsx_record())
+            return;
+        gsx_batch_flush();
+    }
+#endif
+
+    vdipb.contrl = contrl;
+    gsx_trap();
+}
@@ -1,7 +1,7 @@
 /*
  * gsx2.h - VDI (GSX) bindings
  *
- * Copyright (C) 2014-2015 The EmuTOS development team
+ * Copyright (C) 2014-2018 The EmuTOS development team
  *
  * Authors:
  *  VRI   Vincent Rivière
@@ -37,4 +37,10 @@ extern VDIPB vdipb;
 
 void gsx2(void);
 
+#if CONF_WITH_VDI_EXTENSIONS
+void gsx_batch_begin(void);
+void gsx_batch_end(void);
+void gsx_batch_flush(void);
+#endif
+
 #endif /* GSX2_H */
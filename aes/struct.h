@@ -30,8 +30,6 @@ typedef struct fpd     FPD;             /* fork process descriptor      */
 
 typedef UWORD   EVSPEC;
 
-#define NUM_PDS (NUM_ACCS + 2)          /* acc's + ctrlpd + dos appl.   */
-
 /*
  * EVBs are used to track events that an AES process is waiting on.  the
  * maximum number of events that a process can wait for is 6 (MU_KEYBD,
@@ -43,7 +41,6 @@ typedef UWORD   EVSPEC;
 #define EVBS_PER_PD     6               /* EVBs per AES process */
 
 #define KBD_SIZE 8
-#define QUEUE_SIZE 128
 #define NFORKS 32
 
 struct cqueue               /* console keyboard queue */
@@ -129,9 +126,9 @@ struct aespd                /* process descriptor */
         EVB     *p_evlist;      /* 28 */
         EVB     *p_qdq;         /* 2C */
         EVB     *p_qnq;         /* 30 */
-        char    *p_qaddr;       /* 34 */
-        WORD    p_qindex;       /* 38 */
-        char    p_queue[QUEUE_SIZE];   /* 3A */
+        WORD    p_qhead;        /* 34  offset of start of message queue */
+        WORD    p_qindex;       /* 36  number of bytes in message queue */
+        char    p_queue[QUEUE_SIZE];   /* 38  message queue (ring buffer) */
         char    p_appdir[LEN_ZPATH+2];  /* directory containing the executable */
                                         /* (includes trailing path separator)  */
 };
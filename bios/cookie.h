@@ -40,6 +40,7 @@ struct cookie {
 #define COOKIE_COLDFIRE 0x5f43465fL
 #define COOKIE_MCF      0x5f4d4346L
 #define COOKIE__5MS     0x5f354d53L
+#define COOKIE_EAPR     0x45415052L     /* EmuTOS AES profile */
 
 /*
  * values of _MCH cookie
@@ -33,7 +33,7 @@ typedef struct {
         WORD    len;            /* height of saved form */
         UWORD   *addr;          /* screen address of saved form */
         UBYTE    stat;          /* save status */
-        char    reserved;
+        UBYTE   width;          /* pixels saved per row (16-bit modes only) */
         ULONG   area[8*16];     /* handle up to 8 video planes */
 } MCS;
 /* defines for 'stat' above */
@@ -447,7 +447,7 @@ static WORD setup_iconblks(const ICONBLK *ibstart, WORD count)
      * Next, we copy the ICONBLKs to the g_iblist[] array:
      *  g_iblist[] points to the transformed data/transformed mask
      *  & is referenced by act_chkobj() in deskact.c, insa_icon()
-     *  in deskins.c, and win_bldview() in deskwin.c
+     *  in deskins.c, and win_bldobj() in deskwin.c
      */
     memcpy(G.g_iblist, ibstart, count*sizeof(ICONBLK));
 
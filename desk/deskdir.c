@@ -465,6 +465,10 @@ static WORD d_dofcopy(char *psrc_file, char *pdst_file, WORD time, WORD date, WO
 
     /*
      * perform copy
+     *
+     * a read that does not fill the buffer has reached the end of the
+     * file, so we don't need another read to find that out: most files
+     * are copied with a single read & write
      */
     rc = TRUE;
     while(1)
@@ -488,6 +492,12 @@ static WORD d_dofcopy(char *psrc_file, char *pdst_file, WORD time, WORD date, WO
             diskfull = TRUE;
             break;
         }
+
+        if (readlen < copylen)  /* end of file */
+        {
+            dos_setdt(dstfh, time, date);   /* update target date/time */
+            break;
+        }
     }
 
     if (error < 0L)
@@ -850,6 +860,34 @@ static BOOL source_is_parent(char *src, char *dst)
 }
 
 
+/*
+ *  Check if two fully-qualified paths refer to the same folder
+ */
+static BOOL same_folder(char *path1, char *path2)
+{
+    WORD len;
+
+    len = filename_start(path1) - path1;
+    if (len != filename_start(path2) - path2)
+        return FALSE;
+
+    return (strncmp(path1, path2, len) == 0);
+}
+
+
+/*
+ *  Mark an fnode as removed from its folder by dir_op()
+ *
+ *  this allows windows displaying the folder to be updated by pn_remove()
+ *  rather than by re-reading the folder
+ */
+static void mark_removed(PNODE *pspath, FNODE *pf)
+{
+    pf->f_removed = TRUE;
+    pspath->p_removed++;
+}
+
+
 /*
  *  DIRectory routine that does an OPeration on all the selected files and
  *  folders in the source path.  The selected files and folders are
@@ -860,6 +898,7 @@ WORD dir_op(WORD op, WORD icontype, PNODE *pspath, char *pdst_path, DIRCOUNT *co
     OBJECT *tree, *obj;
     FNODE *pf;
     WORD more, confirm;
+    BOOL removing;
     char *ptmpsrc, *ptmpdst, *psrc_path = pspath->p_spec;
     LONG lavail;
     char srcpth[MAXPATHLEN], dstpth[MAXPATHLEN];
@@ -875,6 +914,16 @@ WORD dir_op(WORD op, WORD icontype, PNODE *pspath, char *pdst_path, DIRCOUNT *co
         op = OP_RENAME;
     }
 
+    /*
+     * deleting or moving items removes them from the source folder,
+     * unless they are being moved within it
+     */
+    removing = FALSE;
+    if (op == OP_DELETE)
+        removing = TRUE;
+    else if ((op == OP_MOVE) || (op == OP_RENAME))
+        removing = !same_folder(psrc_path, pdst_path);
+
     tree = NULL;
     if (op != OP_COUNT)
     {
@@ -998,8 +1047,12 @@ WORD dir_op(WORD op, WORD icontype, PNODE *pspath, char *pdst_path, DIRCOUNT *co
                  && (strcmp(srcpth,dstpth) == 0))
                     ;       /* do nothing for copy/move to self */
                 else
+                {
                     more = (op==OP_RENAME) ? d_dofoldren(srcpth,dstpth) :
                             d_doop(0, op, srcpth, dstpth, tree, count);
+                    if (removing && (more > 0))
+                        mark_removed(pspath, pf);
+                }
             }
             if (!more)
                 break;
@@ -1034,6 +1087,8 @@ WORD dir_op(WORD op, WORD icontype, PNODE *pspath, char *pdst_path, DIRCOUNT *co
         }
         if (op != OP_COUNT)
             restore_path(ptmpsrc);  /* restore original source path */
+        if (removing && (more > 0))
+            mark_removed(pspath, pf);
 
         if (tree)
         {
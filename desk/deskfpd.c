@@ -53,6 +53,7 @@ static void fl_free(PNODE *pn)
     pn->p_fbase = pn->p_flist = NULL;
     pn->p_count = 0;
     pn->p_size = 0L;
+    pn->p_removed = 0;
 }
 
 
@@ -85,6 +86,7 @@ PNODE *pn_open(char *pathname, WNODE *pw)
 
     thepath = &pw->w_pnode;
     thepath->p_flist = NULL;    /* file list starts empty */
+    thepath->p_removed = 0;
     strcpy(thepath->p_spec,pathname);
     thepath->p_attr = F_SUBDIR;
 
@@ -118,7 +120,7 @@ static LONG pn_fcomp(FNODE *pf1, FNODE *pf2, WORD which)
         chk = (LONG)pf2->f_size - (LONG)pf1->f_size;
         break;
     case S_TYPE:
-        chk = strcmp(scasb(ps1,'.'),scasb(ps2,'.'));
+        chk = strcmp(ps1+pf1->f_ext,ps2+pf2->f_ext);
         break;
     case S_NSRT:
         chk = (LONG)pf1->f_seq - (LONG)pf2->f_seq;  /* low seq #s sort first */
@@ -150,62 +152,80 @@ static LONG pn_comp(FNODE *pf1, FNODE *pf2)
 }
 
 
+/*
+ *  Merge two sorted fnode lists into one
+ *
+ *  if two fnodes compare equal, the one from list1 goes first, so
+ *  the sort is stable as long as list1 precedes list2 in the original
+ */
+static FNODE *pn_merge(FNODE *list1, FNODE *list2)
+{
+    FNODE *head, *tail;
+
+    tail = (FNODE *)&head;      /* assumes fnode link is at start of fnode */
+
+    while(list1 && list2)
+    {
+        if (pn_comp(list1, list2) <= 0L)
+        {
+            tail->f_next = list1;
+            list1 = list1->f_next;
+        }
+        else
+        {
+            tail->f_next = list2;
+            list2 = list2->f_next;
+        }
+        tail = tail->f_next;
+    }
+    tail->f_next = list1 ? list1 : list2;
+
+    return head;
+}
+
+
 /*
  *  Sort the fnodes in the list chained from the specified pathnode
  *
+ *  this is a bottom-up merge sort of the linked list itself, so it needs
+ *  no extra memory.  part[i] holds a sorted sublist of 2^i fnodes (or is
+ *  empty); since p_count is a WORD, MERGE_LEVELS levels are sufficient.
  */
+#define MERGE_LEVELS    16
+
 FNODE *pn_sort(PNODE *pn)
 {
-    FNODE *pf, *pftemp;
-    FNODE *newlist;
-    FNODE **ml_pfndx;
-    WORD  count, gap, i, j;
+    FNODE *pf, *list;
+    FNODE *part[MERGE_LEVELS];
+    WORD  i;
 
     if (pn->p_count < 2)        /* the list is already sorted */
         return pn->p_flist;
 
-    /*
-     * malloc & build index array
-     */
-    ml_pfndx = dos_alloc_anyram(pn->p_count*sizeof(FNODE *));
-    if (!ml_pfndx)              /* no space, can't sort */
-    {
-        malloc_fail_alert();
-        return pn->p_flist;
-    }
-
-    for (count = 0, pf = pn->p_flist; pf; pf = pf->f_next)
-        ml_pfndx[count++] = pf;
+    for (i = 0; i < MERGE_LEVELS; i++)
+        part[i] = NULL;
 
-    /* sort files using shell sort on page 108 of  K&R C Prog. Lang. */
-    for (gap = count/2; gap > 0; gap /= 2)
+    for (list = pn->p_flist; list; )
     {
-        for (i = gap; i < count; i++)
+        pf = list;
+        list = list->f_next;
+        pf->f_next = NULL;
+
+        /* earlier fnodes are in part[], so they go first */
+        for (i = 0; (i < MERGE_LEVELS-1) && part[i]; i++)
         {
-            for (j = i-gap; j >= 0; j -= gap)
-            {
-                if (pn_comp(ml_pfndx[j], ml_pfndx[j+gap]) <= 0L)
-                    break;
-                pftemp = ml_pfndx[j];
-                ml_pfndx[j] = ml_pfndx[j+gap];
-                ml_pfndx[j+gap] = pftemp;
-            }
+            pf = pn_merge(part[i], pf);
+            part[i] = NULL;
         }
+        part[i] = part[i] ? pn_merge(part[i], pf) : pf;
     }
 
-    /* link up the list in order */
-    newlist = ml_pfndx[0];
-    pf = ml_pfndx[0];
-    for (i = 1; i < count; i++)
-    {
-        pf->f_next = ml_pfndx[i];
-        pf = ml_pfndx[i];
-    }
-    pf->f_next = (FNODE *) NULL;
-
-    dos_free(ml_pfndx);
+    /* merge the sublists, again earliest first */
+    for (i = 0, pf = NULL; i < MERGE_LEVELS; i++)
+        if (part[i])
+            pf = pn_merge(part[i], pf);
 
-    return newlist;
+    return pf;
 }
 
 
@@ -266,8 +286,10 @@ WORD pn_active(PNODE *pn, BOOL include_folders)
         if (G.g_wdta.d_fname[0] == '.') /* skip "." & ".." entries */
             continue;
         fn->f_selected = FALSE;
+        fn->f_removed = FALSE;
         memcpy(&fn->f_attr, &G.g_wdta.d_attrib, 23);
         fn->f_seq = count++;
+        fn->f_ext = scasb(fn->f_name, '.') - fn->f_name;
         size += fn->f_size;
         prev->f_next = fn;      /* link fnodes */
         prev = fn++;
@@ -294,6 +316,37 @@ WORD pn_active(PNODE *pn, BOOL include_folders)
 }
 
 
+/*
+ *  Remove the fnodes that have been marked as removed (by dir_op())
+ *  from the list chained from the specified pathnode
+ *
+ *  this updates the pathnode as if it had been rebuilt by pn_active(),
+ *  without re-reading the directory.  the remaining fnodes are still
+ *  in sequence, so there is no need to resort them.
+ */
+void pn_remove(PNODE *pn)
+{
+    FNODE *fn, *prev;
+
+    prev = (FNODE *)&pn->p_flist;   /* assumes fnode link is at start of fnode */
+
+    for (fn = pn->p_flist; fn; fn = fn->f_next)
+    {
+        if (fn->f_removed)
+        {
+            prev->f_next = fn->f_next;
+            pn->p_count--;
+            pn->p_size -= fn->f_size;
+            continue;
+        }
+        fn->f_selected = FALSE;
+        prev = fn;
+    }
+
+    pn->p_removed = 0;
+}
+
+
 /*
  *  Clear the selection flag in all FNODES chained from the PNODE in the specified WNODE
  */
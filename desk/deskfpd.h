@@ -60,9 +60,11 @@ struct _filenode
     LONG  f_size;               /*    corresponding items in   */
     char  f_name[LEN_ZFNAME];   /*     the DTA structure!      */
     WORD  f_seq;            /* sequence within directory */
-    WORD  f_obid;           /* index into G.g_screen[] for this object */
+    WORD  f_ext;            /* offset of extension ('.' or nul) in f_name[] */
+    WORD  f_obid;           /* index into G.g_screen[] for this object (if in view) */
     ANODE *f_pa;            /* ANODE to get icon# from */
     WORD  f_isap;           /* if TRUE, use a_aicon in ANODE, else use a_dicon */
+    BOOL  f_removed;        /* if TRUE, file/folder has been deleted/moved away */
 };
 
 
@@ -75,6 +77,7 @@ struct _pathnode
     FNODE *p_flist;         /* linked list of fnodes */
     WORD  p_count;          /* number of items (fnodes) */
     LONG  p_size;           /* total size of items */
+    WORD  p_removed;        /* number of fnodes marked as removed */
 };
 
 
@@ -87,5 +90,6 @@ void pn_close(PNODE *thepath);
 PNODE *pn_open(char *pathname, WNODE *pw);
 FNODE *pn_sort(PNODE *pn);
 WORD pn_active(PNODE *thepath, BOOL include_folders);
+void pn_remove(PNODE *pn);
 
 #endif  /* _DESKFPD_H */
@@ -146,7 +146,13 @@ static void rebuild_window(WNODE *pwin)
 {
     GRECT gr;
 
-    pn_active(&pwin->w_pnode, TRUE);
+    /*
+     * if items have only been removed from the window's own path (by
+     * a delete or move from it), we don't need to re-read the directory
+     */
+    if (pwin->w_pnode.p_removed)
+        pn_remove(&pwin->w_pnode);
+    else pn_active(&pwin->w_pnode, TRUE);
     desk_verify(pwin->w_id, TRUE);
     win_sinfo(pwin, FALSE);
     wind_get_grect(pwin->w_id, WF_WXYWH, &gr);
@@ -243,6 +243,17 @@ WORD obj_ialloc(WORD wparent, WORD x, WORD y, WORD w, WORD h)
 }
 
 
+/*
+ *  Free an item object that is no longer linked into the screen tree,
+ *  by putting it at the head of the free chain
+ */
+void obj_ifree(WORD obj)
+{
+    G.g_screen[obj].ob_next = G.g_screenfree;
+    G.g_screenfree = obj;
+}
+
+
 /*
  *  Return the object number of the icon on the desktop corresponding
  *  to the specified drive.
@@ -14,6 +14,7 @@ void obj_init(void);
 WORD obj_walloc(WORD x, WORD y, WORD w, WORD h);
 void obj_wfree(WORD obj, WORD x, WORD y, WORD w, WORD h);
 WORD obj_ialloc(WORD wparent, WORD x, WORD y, WORD w, WORD h);
+void obj_ifree(WORD obj);
 WORD obj_get_obid(WORD drive);
 
 #endif  /* _DESKOBJ_H */
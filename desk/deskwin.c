@@ -258,26 +258,15 @@ WNODE *win_ontop(void)
 static void win_ocalc(WNODE *pwin, WORD wfit, WORD hfit, FNODE **ppstart)
 {
     FNODE *pf;
-    WORD  start, cnt, w_space;
+    WORD  start, w_space;
 
     if (wfit < 1)       /* this happens when displaying as text */
         wfit = 1;
     if (hfit < 1)
         hfit = 1;
 
-    /*
-     * zero out obid ptrs in flist and count up
-     * number of files in virtual file space
-     */
-    cnt = 0;
-    for (pf = pwin->w_pnode.p_flist; pf; pf = pf->f_next)
-    {
-        pf->f_obid = NIL;
-        cnt++;
-    }
-
     /* set windows virtual number of rows */
-    pwin->w_vnrow = (cnt + wfit - 1) / wfit;
+    pwin->w_vnrow = (pwin->w_pnode.p_count + wfit - 1) / wfit;
     if (pwin->w_vnrow < 1)
         pwin->w_vnrow = 1;
 
@@ -311,20 +300,113 @@ static void win_icalc(FNODE *pfnode, WNODE *pwin)
 }
 
 
+/*
+ *  Allocate & build the object for a file at the specified row & column
+ *  of a window's current view
+ *
+ *  Returns the object number, or 0 if no objects are available
+ */
+static WORD win_bldobj(WNODE *pwin, FNODE *pf, WORD r_cnt, WORD c_cnt)
+{
+    OBJECT *obj;
+    SCREENINFO *si;
+    USERBLK *ub;
+    ICONBLK *ib;
+    ANODE *anode;
+    WORD  obid, i_index;
+
+    /* allocate object */
+    obid = obj_ialloc(pwin->w_root, c_cnt * G.g_iwspc + G.g_iwint,
+                    r_cnt * G.g_ihspc + G.g_ihint, G.g_iwext, G.g_ihext);
+    if (!obid)          /* can't allocate item object */
+    {
+        KDEBUG(("win_bldobj(): can't create window item object\n"));
+        return 0;
+    }
+
+    /* remember it          */
+    pf->f_obid = obid;
+    si = &G.g_screeninfo[obid];
+    si->fnptr = pf;
+
+    /* build object */
+    obj = &G.g_screen[obid];
+    obj->ob_state = INITIAL_ICON_STATE;
+    if (pf->f_selected)
+        obj->ob_state |= SELECTED;
+    obj->ob_flags = 0x00;
+    switch(G.g_iview)
+    {
+    case V_TEXT:
+        ub = &si->u.udef;
+        obj->ob_type = G_USERDEF;
+        obj->ob_spec = (LONG)ub;
+        ub->ub_code = dr_code;
+        ub->ub_parm = (LONG)pf;
+        win_icalc(pf, pwin);
+        break;
+    case V_ICON:
+        ib = &si->u.icon.block;
+        obj->ob_type = G_ICON;
+        win_icalc(pf, pwin);
+        anode = pf->f_pa;
+        if (anode)
+            i_index = (pf->f_isap) ? anode->a_aicon : anode->a_dicon;
+        else
+        {
+            KDEBUG(("win_bldobj(): NULL anode, using defaults\n"));
+            if (pf->f_attr&F_SUBDIR)
+                i_index = IG_FOLDER;
+            else
+                i_index = (pf->f_isap) ? IG_APPL : IG_DOCU;
+        }
+        si->u.icon.index = i_index;
+        obj->ob_spec = (LONG)ib;
+        memcpy(ib, &G.g_iblist[i_index], sizeof(ICONBLK));
+        ib->ib_ptext = pf->f_name;
+        if (anode)
+            ib->ib_char |= anode->a_letter;
+        break;
+    }
+
+    return obid;
+}
+
+
+/*
+ *  Set the size & position of a window's sliders from its current view
+ */
+static void win_setsliders(WNODE *pwin)
+{
+    WORD  wh, sl_size, sl_value;
+
+    wh = pwin->w_id;
+    wind_set(wh, WF_HSLSIZ, 1000, 0, 0, 0);
+    sl_size = mul_div(pwin->w_pnrow, 1000, pwin->w_vnrow);
+    wind_set(wh, WF_VSLSIZ, sl_size, 0, 0, 0);
+
+    if (pwin->w_vnrow > pwin->w_pnrow)
+        sl_value = mul_div(pwin->w_cvrow, 1000, pwin->w_vnrow-pwin->w_pnrow);
+    else
+        sl_value = 0;
+    wind_set(wh, WF_VSLIDE, sl_value, 0, 0, 0);
+}
+
+
 /*
  *  Build an object tree of the list of files that are currently
  *  viewable in a window.  Next adjust root of tree to take into
  *  account the current view of the window.
+ *
+ *  Objects are only built for the files in the visible rows (plus
+ *  a partly-visible row at the bottom), so the number of objects
+ *  depends on the window size rather than the number of files.
  */
 void win_bldview(WNODE *pwin, WORD x, WORD y, WORD w, WORD h)
 {
     FNODE *pstart;
-    ANODE *anode;
-    WORD  obid;
     WORD  r_cnt, c_cnt;
     WORD  o_wfit, o_hfit;       /* object grid */
-    WORD  i_index;
-    WORD  xoff, yoff, wh, sl_size, sl_value;
 
     /* free all this window's kids and set size */
     obj_wfree(pwin->w_root, x, y, w, h);
@@ -336,68 +418,8 @@ void win_bldview(WNODE *pwin, WORD x, WORD y, WORD w, WORD h)
     r_cnt = c_cnt = 0;
     while ((c_cnt < o_wfit) && (r_cnt < o_hfit) && pstart)
     {
-        OBJECT *obj;
-        SCREENINFO *si;
-        USERBLK *ub;
-        ICONBLK *ib;
-
-        /* calc offset */
-        yoff = r_cnt * G.g_ihspc;
-        xoff = c_cnt * G.g_iwspc;
-
-        /* allocate object */
-        obid = obj_ialloc(pwin->w_root, xoff + G.g_iwint, yoff + G.g_ihint,
-                                 G.g_iwext, G.g_ihext);
-        if (!obid)          /* can't allocate item object */
-        {
-            KDEBUG(("win_bldview(): can't create window item object\n"));
+        if (!win_bldobj(pwin, pstart, r_cnt, c_cnt))
             break;
-        }
-
-        /* remember it          */
-        pstart->f_obid = obid;
-        si = &G.g_screeninfo[obid];
-        si->fnptr = pstart;
-
-        /* build object */
-        obj = &G.g_screen[obid];
-        obj->ob_state = INITIAL_ICON_STATE;
-        if (pstart->f_selected)
-            obj->ob_state |= SELECTED;
-        obj->ob_flags = 0x00;
-        switch(G.g_iview)
-        {
-        case V_TEXT:
-            ub = &si->u.udef;
-            obj->ob_type = G_USERDEF;
-            obj->ob_spec = (LONG)ub;
-            ub->ub_code = dr_code;
-            ub->ub_parm = (LONG)pstart;
-            win_icalc(pstart, pwin);
-            break;
-        case V_ICON:
-            ib = &si->u.icon.block;
-            obj->ob_type = G_ICON;
-            win_icalc(pstart, pwin);
-            anode = pstart->f_pa;
-            if (anode)
-                i_index = (pstart->f_isap) ? anode->a_aicon : anode->a_dicon;
-            else
-            {
-                KDEBUG(("win_bldview(): NULL anode, using defaults\n"));
-                if (pstart->f_attr&F_SUBDIR)
-                    i_index = IG_FOLDER;
-                else
-                    i_index = (pstart->f_isap) ? IG_APPL : IG_DOCU;
-            }
-            si->u.icon.index = i_index;
-            obj->ob_spec = (LONG)ib;
-            memcpy(ib, &G.g_iblist[i_index], sizeof(ICONBLK));
-            ib->ib_ptext = pstart->f_name;
-            if (anode)
-                ib->ib_char |= anode->a_letter;
-            break;
-        }
         pstart = pstart->f_next;
         c_cnt++;
         if (c_cnt == o_wfit)
@@ -408,17 +430,75 @@ void win_bldview(WNODE *pwin, WORD x, WORD y, WORD w, WORD h)
         }
     }
 
-    /* set slider size & position */
-    wh = pwin->w_id;
-    wind_set(wh, WF_HSLSIZ, 1000, 0, 0, 0);
-    sl_size = mul_div(pwin->w_pnrow, 1000, pwin->w_vnrow);
-    wind_set(wh, WF_VSLSIZ, sl_size, 0, 0, 0);
+    win_setsliders(pwin);
+}
 
-    if (pwin->w_vnrow > pwin->w_pnrow)
-        sl_value = mul_div(pwin->w_cvrow, 1000, pwin->w_vnrow-pwin->w_pnrow);
-    else
-        sl_value = 0;
-    wind_set(wh, WF_VSLIDE, sl_value, 0, 0, 0);
+
+/*
+ *  Update the objects in a window's view after it has been scrolled
+ *  vertically from row 'oldcv' to the current row
+ *
+ *  The window's objects are in file sequence, so the objects for the
+ *  files that remain in view are simply moved to their new positions;
+ *  only the files that scroll into view need new objects.  As a check,
+ *  an object is only kept if it still points to the expected FNODE.
+ */
+static void win_scroll(WNODE *pwin, WORD oldcv)
+{
+    OBJECT *root;
+    FNODE *pf;
+    WORD  old, next, obid, i, oldi, start, end, r_cnt, c_cnt;
+
+    start = pwin->w_cvrow * pwin->w_pncol;
+    end = start + min(pwin->w_pnrow + 1, pwin->w_vnrow - pwin->w_cvrow) * pwin->w_pncol;
+
+    /* detach the old objects, which start at file# oldi */
+    root = &G.g_screen[pwin->w_root];
+    old = root->ob_head;
+    oldi = oldcv * pwin->w_pncol;
+    root->ob_head = root->ob_tail = NIL;
+
+    for (i = 0, pf = pwin->w_pnode.p_flist; pf && (i < start); i++)
+        pf = pf->f_next;
+
+    for (r_cnt = c_cnt = 0; pf && (i < end); i++, pf = pf->f_next)
+    {
+        /* free any old objects for files that have scrolled out of view */
+        for ( ; (old >= WOBS_START) && (oldi < i); oldi++)
+        {
+            next = G.g_screen[old].ob_next;
+            obj_ifree(old);
+            old = next;
+        }
+
+        if ((old >= WOBS_START) && (oldi == i) && (G.g_screeninfo[old].fnptr == pf))
+        {
+            obid = old;
+            old = G.g_screen[old].ob_next;
+            oldi++;
+            objc_add(G.g_screen, pwin->w_root, obid);
+            G.g_screen[obid].ob_x = c_cnt * G.g_iwspc + G.g_iwint;
+            G.g_screen[obid].ob_y = r_cnt * G.g_ihspc + G.g_ihint;
+        }
+        else if (!win_bldobj(pwin, pf, r_cnt, c_cnt))
+            break;
+
+        if (++c_cnt == pwin->w_pncol)
+        {
+            r_cnt++;
+            c_cnt = 0;
+        }
+    }
+
+    /* free any old objects that are left */
+    while(old >= WOBS_START)
+    {
+        next = G.g_screen[old].ob_next;
+        obj_ifree(old);
+        old = next;
+    }
+
+    win_setsliders(pwin);
 }
 
 
@@ -440,7 +520,7 @@ static void win_blt(WNODE *pw, WORD newcv)
         return;
 
     wind_get_grect(pw->w_id, WF_WXYWH, &c);
-    win_bldview(pw, c.g_x, c.g_y, c.g_w, c.g_h);
+    win_scroll(pw, newcv - delcv);
 
     /* see if any part is off the screen */
     wind_get_grect(pw->w_id, WF_FIRSTXYWH, &t);
@@ -643,7 +723,7 @@ void win_sinfo(WNODE *pwin, BOOL check_selected)
 {
     PNODE *pn;
     FNODE *fn;
-    WORD i, select_count = 0;
+    WORD select_count = 0;
     LONG select_size = 0L;
 
     pn = &pwin->w_pnode;
@@ -651,7 +731,7 @@ void win_sinfo(WNODE *pwin, BOOL check_selected)
     if (check_selected)
     {
         /* count selected FNODEs */
-        for (i = 0, fn = pn->p_fbase; i < pn->p_count; i++, fn++)
+        for (fn = pn->p_flist; fn; fn = fn->f_next)
         {
             if (fn->f_selected)
             {
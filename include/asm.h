@@ -193,7 +193,7 @@ static __inline__ void swpcopyw(const UWORD* src, UWORD* dest)
  * rolw1(WORD x);
  *  rotates x leftwards by 1 bit
  */
-#ifdef __mcoldfire__
+#if defined(__mcoldfire__) || !defined(__m68k__)
 #define rolw1(x)    x=(x>>15)|(x<<1)
 #else
 #define rolw1(x)                    \
@@ -210,7 +210,7 @@ static __inline__ void swpcopyw(const UWORD* src, UWORD* dest)
  * rorw1(WORD x);
  *  rotates x rightwards by 1 bit
  */
-#ifdef __mcoldfire__
+#if defined(__mcoldfire__) || !defined(__m68k__)
 #define rorw1(x)    x=(x>>1)|(x<<15)
 #else
 #define rorw1(x)                    \
@@ -1136,6 +1136,15 @@
 # define CONF_WITH_PCGEM 1
 #endif
 
+/*
+ * Set CONF_WITH_AES_PROFILE to 1 to collect AES redraw statistics
+ * (WM_REDRAW messages, rectangles, pixels & response times, for each
+ * window and process).  They are found via a cookie: see aes/gemprof.c.
+ */
+#ifndef CONF_WITH_AES_PROFILE
+# define CONF_WITH_AES_PROFILE 0
+#endif
+
 /*
  * Set CONF_WITH_BIOS_EXTENSIONS to 1 to support various BIOS extension functions
  */
@@ -1150,6 +1159,23 @@
 # define CONF_WITH_VDI_EXTENSIONS 1
 #endif
 
+/*
+ * Set CONF_WITH_VDI_16BIT to 1 to support VDI drawing in the 16-bit
+ * (65536 colour) Videl modes
+ */
+#ifndef CONF_WITH_VDI_16BIT
+# define CONF_WITH_VDI_16BIT CONF_WITH_VIDEL
+#endif
+
+/*
+ * Set CONF_WITH_VDI_PROFILE to 1 to collect VDI performance counters
+ * (calls, pixels written & elapsed time for each opcode).  They are
+ * controlled and read via a VDI escape: see vdi/vdi_profile.c.
+ */
+#ifndef CONF_WITH_VDI_PROFILE
+# define CONF_WITH_VDI_PROFILE 0
+#endif
+
 /*
  * Set CONF_WITH_VDI_VERTLINE to 1 to improve VDI vertical line performance
  */
@@ -1157,6 +1183,15 @@
 # define CONF_WITH_VDI_VERTLINE 1
 #endif
 
+/*
+ * Set CONF_WITH_VDI_ASYNC_BLIT to 1 to let the VDI start the last blitter
+ * operation of a primitive without waiting for it to finish, so that the
+ * CPU can set up the next one meanwhile (see vdi/vdi_line.c)
+ */
+#ifndef CONF_WITH_VDI_ASYNC_BLIT
+# define CONF_WITH_VDI_ASYNC_BLIT CONF_WITH_BLITTER
+#endif
+
 /*
  * Set CONF_WITH_FORMAT to 1 to support formatting floppy diskettes in EmuDesk
  */
@@ -1425,14 +1460,26 @@
 /*
  * System configuration definitions
  */
-#define NUM_WIN 8               /* maximum number of windows (the     */
+#ifndef NUM_WIN
+# define NUM_WIN 16             /* maximum number of windows (the     */
                                 /* desktop itself counts as 1 window) */
+                                /* the AES allocates the window       */
+                                /* tables at startup, using fewer     */
+                                /* windows if memory is short         */
+#endif
 
-#define NUM_ACCS 6              /* maximum number of desk accessory   */
+#ifndef NUM_ACCS
+# define NUM_ACCS 8             /* maximum number of desk accessory   */
                                 /* files (.ACC) that will be loaded   */
                                 /* AND the maximum number of desk     */
                                 /* accessory slots available (one     */
                                 /* slot per mn_register() call)       */
+#endif
+
+#ifndef QUEUE_SIZE
+# define QUEUE_SIZE 512         /* size in bytes of the message queue */
+                                /* of each AES process                */
+#endif
 
 #define BLKDEVNUM 26                    /* number of block devices supported: A: ... Z: */
 #define INF_FILE_NAME "A:\\EMUDESK.INF" /* path to saved desktop file */
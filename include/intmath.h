@@ -1,7 +1,7 @@
 /*
  * intmath.h - misc integer math routines
  *
- * Copyright (C) 2002-2016 The EmuTOS development team
+ * Copyright (C) 2002-2018 The EmuTOS development team
  *
  * This file is distributed under the GPL, version 2 or at your
  * option any later version.  See doc/license.txt for details.
@@ -43,9 +43,14 @@ WORD max(WORD a, WORD b)
  * mul_div - signed integer multiply and divide
  * return ( m1 * m2 ) / d1
  * While the operands are WORD, the intermediate result is LONG.
+ *
+ * The portable C versions of this and the following functions allow the
+ * code that uses them (notably the VDI) to be compiled for other CPUs,
+ * e.g. to exercise it on a development host.
  */
 static __inline__ WORD mul_div(WORD m1, WORD m2, WORD d1)
 {
+#ifdef __m68k__
     __asm__ (
       "muls %1,%0\n\t"
       "divs %2,%0"
@@ -54,6 +59,9 @@ static __inline__ WORD mul_div(WORD m1, WORD m2, WORD d1)
     );
 
     return m1;
+#else
+    return (WORD)(((LONG)m1 * m2) / d1);
+#endif
 }
 
 /*
@@ -63,6 +71,7 @@ static __inline__ WORD mul_div(WORD m1, WORD m2, WORD d1)
  */
 static __inline__ LONG muls(WORD m1, WORD m2)
 {
+#ifdef __m68k__
     LONG ret;
 
     __asm__ (
@@ -72,6 +81,9 @@ static __inline__ LONG muls(WORD m1, WORD m2)
     );
 
     return ret;
+#else
+    return (LONG)m1 * m2;
+#endif
 }
 
 /*
@@ -82,6 +94,7 @@ static __inline__ LONG muls(WORD m1, WORD m2)
  */
 static __inline__ UWORD divu(ULONG d1, UWORD d2)
 {
+#ifdef __m68k__
     __asm__ (
       "divu %1,%0"
     : "+d"(d1)
@@ -90,4 +103,7 @@ static __inline__ UWORD divu(ULONG d1, UWORD d2)
     );
 
     return (UWORD)d1;
+#else
+    return (UWORD)(d1 / d2);
+#endif
 }
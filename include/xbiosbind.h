@@ -58,6 +58,8 @@
 #define Blitmode(a) xbios_w_w(64, a)
 #define EgetShift() xbios_w_v(81)
 #define EsetColor(a,b) xbios_w_ww(83,a,b)
+#define EsetPalette(a,b,c) xbios_v_wwl(84,a,b,c)
+#define EgetPalette(a,b,c) xbios_v_wwl(85,a,b,c)
 #define VsetMode(a) xbios_w_w(88,a)
 #define VgetMonitor() xbios_w_v(89)
 #define VsetRGB(a,b,c) xbios_v_wwl(93,a,b,c)
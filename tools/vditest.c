@@ -0,0 +1,658 @@
+/*
+ * vditest.c - run the VDI drawing code on the build host
+ *
+ * Copyright (C) 2018 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+/*
+ * This tool links the VDI drawing code (vdi/vdi_fill.c, vdi_line.c,
+ * vdi_gdp.c, vdi_marker.c & vdi_region.c) with an in-memory screen, so
+ * that changes to the rasterisation code can be checked & timed without
+ * running EmuTOS.
+ *
+ * Each test case draws a scene via the same VDI functions that the
+ * dispatcher calls, once in a monochrome screen & once in a 4-plane
+ * screen.  The result is compared with the reference image for the case
+ * in the reference directory (tools/vditest by default): monochrome
+ * images are PBM files, 4-plane images are PGM files whose grey values
+ * are the hardware colour register numbers.
+ *
+ * usage: vditest [-g] [-b count] [refdir]
+ *  -g          (re)generate the reference images instead of comparing
+ *  -b count    draw each scene 'count' times & report the time taken
+ *
+ * The exit status is 0 if all images match, 1 otherwise.  "make vditest-check"
+ * builds the tool & runs it from the top directory.
+ *
+ * Only the functions that the drawing code needs from the rest of the
+ * VDI & the BIOS are provided here, as simple host versions (see the end
+ * of this file); the Line-A variables are ordinary globals.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+
+#include "config.h"
+#include "portab.h"
+#include "vdi_defs.h"
+#include "../bios/lineavars.h"
+
+#define SCREEN_W    256
+#define SCREEN_H    160
+#define MAX_PLANES  4
+#define MAX_PATH    256
+#define MAXCOLOURS  16          /* enough for MAX_PLANES */
+
+/* Line-A & VDI variables (normally in bios/lineavars.S & vdi/) */
+UBYTE *v_bas_ad;
+UWORD v_planes, v_lin_wr, V_REZ_HZ, V_REZ_VT;
+WORD DEV_TAB[45], SIZ_TAB[12], INQ_TAB[45];
+WORD *CONTRL, *INTIN, *PTSIN, *INTOUT, *PTSOUT;
+WORD LN_MASK, LSTLIN;
+WORD MAP_COL[MAXCOLOURS], REV_MAP_COL[MAXCOLOURS];
+WORD MFILL;
+WORD X1, Y1, X2, Y2, WRT_MODE, CLIP;
+WORD COLBIT0, COLBIT1, COLBIT2, COLBIT3;
+WORD XMINCL, XMAXCL, YMINCL, YMAXCL;
+UWORD *PATPTR, PATMSK;
+Vwk *CUR_WORK;
+WORD (*SEEDABORT)(void);
+WORD flip_y, line_cw, num_qc_lines;
+
+static UWORD screen[SCREEN_W/16*MAX_PLANES*SCREEN_H];
+static WORD contrl[12], intin[128], ptsin[256], intout[128], ptsout[128];
+static Vwk vwk;
+
+/* as set up by vdi_v_opnwk() & init_colors() */
+static const WORD MAP_COL_ROM[] =
+    { 0, 15, 1, 2, 4, 6, 3, 5, 7, 8, 9, 10, 12, 14, 11, 13 };
+
+
+/*
+ * set up the screen variables & an open workstation for 'planes' planes
+ */
+static void open_screen(WORD planes)
+{
+    WORD i, numcol = 1 << planes;
+
+    memset(screen, 0, sizeof(screen));
+    v_bas_ad = (UBYTE *)screen;
+    v_planes = planes;
+    v_lin_wr = SCREEN_W / 8 * planes;
+    V_REZ_HZ = SCREEN_W;
+    V_REZ_VT = SCREEN_H;
+
+    CONTRL = contrl;
+    INTIN = intin;
+    PTSIN = ptsin;
+    INTOUT = intout;
+    PTSOUT = ptsout;
+
+    memset(DEV_TAB, 0, sizeof(DEV_TAB));
+    xres = SCREEN_W - 1;
+    yres = SCREEN_H - 1;
+    xsize = ysize = 372;
+    numcolors = numcol;
+    INQ_TAB[4] = planes;
+    SIZ_TAB[4] = 1;
+    SIZ_TAB[6] = MAX_LINE_WIDTH;
+    SIZ_TAB[8] = 15;
+    SIZ_TAB[9] = 11;
+    SIZ_TAB[10] = 120;
+    SIZ_TAB[11] = 88;
+
+    for (i = 0; i < MAXCOLOURS; i++)
+        MAP_COL[i] = (i < 16) ? MAP_COL_ROM[i] & (numcol - 1) : i;
+    MAP_COL[1] = numcol - 1;
+    for (i = 0; i < MAXCOLOURS; i++)
+        REV_MAP_COL[MAP_COL[i]] = i;
+
+    line_cw = -1;
+    flip_y = 0;
+
+    memset(&vwk, 0, sizeof(vwk));
+    vwk.handle = 1;
+    vwk.line_index = 0;
+    vwk.line_width = 1;
+    vwk.line_color = MAP_COL[1];
+    vwk.mark_color = MAP_COL[1];
+    vwk.mark_index = 2;
+    vwk.mark_height = 11;
+    vwk.mark_scale = 1;
+    vwk.fill_color = MAP_COL[1];
+    vwk.fill_style = 1;
+    vwk.fill_per = TRUE;
+    vwk.wrt_mode = 0;
+    vwk.xfm_mode = 2;
+    vwk.xmx_clip = xres;
+    vwk.ymx_clip = yres;
+    st_fl_ptr(&vwk);
+    CUR_WORK = &vwk;
+}
+
+
+/*
+ * helpers to call VDI functions with their arguments in INTIN/PTSIN
+ */
+static void set1(void (*func)(Vwk *), WORD value)
+{
+    INTIN[0] = value;
+    CONTRL[3] = 1;
+    (*func)(&vwk);
+}
+
+static void line_width(WORD width)
+{
+    PTSIN[0] = width;
+    PTSIN[1] = 0;
+    vdi_vsl_width(&vwk);
+}
+
+static void line_ends(WORD beg, WORD end)
+{
+    INTIN[0] = beg;
+    INTIN[1] = end;
+    vdi_vsl_ends(&vwk);
+}
+
+static void mark_height(WORD height)
+{
+    PTSIN[0] = 0;
+    PTSIN[1] = height;
+    vdi_vsm_height(&vwk);
+}
+
+static void fill(WORD style, WORD index, WORD color)
+{
+    set1(vdi_vsf_interior, style);
+    set1(vdi_vsf_style, index);
+    set1(vdi_vsf_color, color);
+}
+
+/* as vdi_vswr_mode() in vdi/vdi_control.c, which is not linked in */
+static void wrt_mode(WORD mode)
+{
+    vwk.wrt_mode = mode - 1;
+}
+
+/* as vdi_vs_clip() in vdi/vdi_control.c, which is not linked in */
+static void clip(WORD on, WORD x1, WORD y1, WORD x2, WORD y2)
+{
+    vwk.clip = on;
+    if (on) {
+        vwk.xmn_clip = x1;
+        vwk.ymn_clip = y1;
+        vwk.xmx_clip = x2;
+        vwk.ymx_clip = y2;
+    } else {
+        vwk.xmn_clip = 0;
+        vwk.ymn_clip = 0;
+        vwk.xmx_clip = xres;
+        vwk.ymx_clip = yres;
+    }
+}
+
+/* call 'func' with the 'count' points following 'count' in PTSIN */
+static void points(void (*func)(Vwk *), WORD subfunction, WORD count, ...)
+{
+    va_list ap;
+    WORD i;
+
+    va_start(ap, count);
+    for (i = 0; i < 2*count; i++)
+        PTSIN[i] = va_arg(ap, int);
+    va_end(ap);
+
+    CONTRL[1] = count;
+    CONTRL[5] = subfunction;
+    (*func)(&vwk);
+}
+
+static void gdp(WORD subfunction, WORD count, WORD nintin, const WORD *pts, const WORD *ints)
+{
+    memcpy(PTSIN, pts, 2*count*sizeof(WORD));
+    if (nintin)
+        memcpy(INTIN, ints, nintin*sizeof(WORD));
+    CONTRL[1] = count;
+    CONTRL[3] = nintin;
+    CONTRL[5] = subfunction;
+    vdi_v_gdp(&vwk);
+}
+
+
+/*
+ * the test cases
+ */
+static void draw_lines(void)
+{
+    WORD i;
+
+    for (i = 0; i < 7; i++)
+    {
+        set1(vdi_vsl_type, i ? i : 7);
+        if (i == 0)
+        {
+            INTIN[0] = 0xcccc;
+            vdi_vsl_udsty(&vwk);
+        }
+        set1(vdi_vsl_color, i + 1);
+        points(vdi_v_pline, 0, 2, 4, 4+6*i, 124, 10+6*i);
+    }
+
+    set1(vdi_vsl_type, 1);
+    for (i = 0; i < 5; i++)
+    {
+        line_width(1 + 4*i);
+        line_ends(i % 3, (i+1) % 3);
+        set1(vdi_vsl_color, 2 + i);
+        points(vdi_v_pline, 0, 3, 140+20*i, 10, 150+20*i, 60, 135+20*i, 70);
+    }
+
+    /* a fan of lines, some clipped, in xor mode */
+    line_width(1);
+    line_ends(0, 0);
+    wrt_mode(MD_XOR);
+    clip(1, 20, 80, 200, 150);
+    for (i = 0; i <= 16; i++)
+        points(vdi_v_pline, 0, 2, 110, 118, 110 + 16*(i-8)*2, i&1 ? 70 : 160);
+    wrt_mode(MD_REPLACE);
+}
+
+static void draw_fills(void)
+{
+    static const WORD star[] = { 190,82, 206,130, 160,100, 220,100, 174,130 };
+    WORD i;
+
+    for (i = 0; i < 24; i++)
+    {
+        fill(2 + i/12, 1 + i%12, 1 + i%7);
+        points(vdi_vr_recfl, 0, 2, 4+20*(i%12), 4+34*(i/12), 21+20*(i%12), 34+34*(i/12));
+    }
+
+    /* concave polygon, clipped, with & without perimeter */
+    fill(2, 4, 3);
+    clip(1, 8, 76, 120, 150);
+    set1(vdi_vsf_perimeter, 1);
+    points(vdi_v_fillarea, 0, 5, 60,72, 80,150, 10,100, 110,100, 40,150);
+    clip(0, 0, 0, 0, 0);
+    set1(vdi_vsf_perimeter, 0);
+    memcpy(PTSIN, star, sizeof(star));
+    CONTRL[1] = 5;
+    CONTRL[5] = 0;
+    vdi_v_fillarea(&vwk);
+
+    /* transparent & reverse transparent fills over it */
+    fill(3, 3, 1);
+    wrt_mode(MD_TRANS);
+    points(vdi_vr_recfl, 0, 2, 130, 90, 250, 110);
+    wrt_mode(MD_ERASE);
+    points(vdi_vr_recfl, 0, 2, 130, 120, 250, 150);
+    wrt_mode(MD_REPLACE);
+}
+
+static void draw_curves(void)
+{
+    static const WORD circle[] = { 40,40, 0,0, 32,0 };
+    static const WORD ellipse[] = { 120,40, 48,28 };
+    static const WORD arc[] = { 200,40, 0,0, 0,0, 30,0 };
+    static const WORD arc_ang[] = { 450, 3150 };
+    static const WORD pie[] = { 40,120, 0,0, 0,0, 30,0 };
+    static const WORD pie_ang[] = { 0, 2700 };
+    static const WORD earc[] = { 120,120, 50,24 };
+    static const WORD earc_ang[] = { 900, 2250 };
+    static const WORD epie[] = { 200,120, 44,30 };
+    static const WORD epie_ang[] = { 1800, 900 };
+
+    fill(2, 2, 2);
+    gdp(4, 3, 0, circle, NULL);             /* circle */
+    fill(3, 5, 3);
+    gdp(5, 2, 0, ellipse, NULL);            /* ellipse */
+    line_width(5);
+    set1(vdi_vsl_color, 4);
+    gdp(2, 4, 2, arc, arc_ang);             /* arc */
+    line_width(1);
+    fill(2, 8, 5);
+    gdp(3, 4, 2, pie, pie_ang);             /* pie */
+    line_ends(1, 2);
+    gdp(6, 2, 2, earc, earc_ang);           /* elliptical arc */
+    line_ends(0, 0);
+    fill(1, 1, 6);
+    gdp(7, 2, 2, epie, epie_ang);           /* elliptical pie */
+}
+
+static void draw_boxes(void)
+{
+    static const WORD box1[] = { 8,8, 120,70 };
+    static const WORD box2[] = { 136,8, 248,70 };
+    static const WORD box3[] = { 8,86, 120,150 };
+    static const WORD box4[] = { 136,86, 248,150 };
+    WORD pts[10];
+
+    set1(vdi_vsl_color, 2);
+    gdp(8, 2, 0, box1, NULL);               /* rounded box */
+    fill(2, 3, 3);
+    gdp(9, 2, 0, box2, NULL);               /* filled rounded box */
+    set1(vdi_vsf_perimeter, 1);
+    fill(3, 8, 4);
+    memcpy(pts, box3, sizeof(box3));
+    gdp(1, 2, 0, pts, NULL);                /* bar (modifies PTSIN) */
+    set1(vdi_vsf_perimeter, 0);
+    fill(2, 19, 5);
+    clip(1, 150, 100, 230, 140);
+    gdp(9, 2, 0, box4, NULL);
+    clip(0, 0, 0, 0, 0);
+}
+
+static void draw_markers(void)
+{
+    WORD type, height;
+
+    for (type = 1; type <= 6; type++)
+    {
+        set1(vdi_vsm_type, type);
+        set1(vdi_vsm_color, type);
+        for (height = 0; height < 4; height++)
+        {
+            mark_height(5 + 8*height);
+            points(vdi_v_pmarker, 0, 2, 20+40*(type-1), 20+36*height,
+                        30+40*(type-1), 24+36*height);
+        }
+    }
+}
+
+static void draw_contour(void)
+{
+    static const WORD circle[] = { 128,80, 0,0, 60,0 };
+
+    set1(vdi_vsf_perimeter, 1);
+    fill(0, 0, 1);
+    gdp(4, 3, 0, circle, NULL);
+    points(vdi_v_pline, 0, 2, 68, 80, 188, 80);
+
+    /* fill the upper half up to the black border */
+    fill(2, 5, 2);
+    INTIN[0] = 1;
+    points(vdi_v_contourfill, 0, 1, 128, 60);
+
+    /* fill the lower half, i.e. the area of the seed point's colour */
+    fill(3, 1, 3);
+    INTIN[0] = -1;
+    points(vdi_v_contourfill, 0, 1, 128, 100);
+}
+
+/* as the dispatcher does for a workstation with a clip region */
+static void region(void (*func)(Vwk *), Rect *rect, WORD count)
+{
+    if (region_set(&vwk, rect, count) == 0)
+        return;
+    vwk.clip = 1;
+    cur_region = &vwk.region;
+    (*func)(&vwk);
+    cur_region = NULL;
+    vwk.region.count = 0;
+    clip(0, 0, 0, 0, 0);
+}
+
+static void draw_region(void)
+{
+    static const WORD circle[] = { 128,80, 0,0, 70,0 };
+    Rect rect[3] = { { 20,4, 110,70 }, { 150,30, 236,150 }, { 40,100, 120,140 } };
+
+    fill(0, 0, 1);
+    gdp(4, 3, 0, circle, NULL);
+    points(vdi_v_pline, 0, 2, 58, 80, 198, 80);
+
+    /* v_bar() across the top of the region */
+    PTSIN[0] = 0;
+    PTSIN[1] = 0;
+    PTSIN[2] = 255;
+    PTSIN[3] = 8;
+    fill(2, 4, 4);
+    CONTRL[1] = 2;
+    CONTRL[5] = 1;
+    region(vdi_v_gdp, rect, 3);
+
+    /* fill the upper half of the circle, which crosses two rectangles */
+    fill(1, 1, 2);
+    INTIN[0] = 1;
+    PTSIN[0] = 160;
+    PTSIN[1] = 60;
+    region(vdi_v_contourfill, rect, 3);
+
+    /* the seed point is outside the region, so nothing is filled */
+    fill(1, 1, 3);
+    PTSIN[0] = 128;
+    PTSIN[1] = 100;
+    region(vdi_v_contourfill, rect, 3);
+}
+
+typedef struct {
+    const char *name;
+    void (*draw)(void);
+} TESTCASE;
+
+static const TESTCASE testcase[] = {
+    { "lines", draw_lines },
+    { "fills", draw_fills },
+    { "curves", draw_curves },
+    { "boxes", draw_boxes },
+    { "markers", draw_markers },
+    { "contour", draw_contour },
+    { "region", draw_region },
+};
+#define NUM_TESTCASES   (sizeof(testcase)/sizeof(testcase[0]))
+
+
+/*
+ * convert the screen to a PBM (1 plane) or PGM (4 planes) image in 'buf'
+ *
+ * returns the length of the image
+ */
+static size_t make_image(UBYTE *buf)
+{
+    UBYTE *p = buf;
+    const UWORD *line;
+    WORD x, y, plane, pel;
+
+    if (v_planes == 1)
+        p += sprintf((char *)p, "P4\n%d %d\n", SCREEN_W, SCREEN_H);
+    else
+        p += sprintf((char *)p, "P5\n%d %d\n%d\n", SCREEN_W, SCREEN_H, (1<<v_planes)-1);
+
+    for (y = 0, line = screen; y < SCREEN_H; y++, line += v_lin_wr/2)
+    {
+        if (v_planes == 1)
+        {
+            for (x = 0; x < SCREEN_W/16; x++)
+            {
+                *p++ = line[x] >> 8;
+                *p++ = line[x] & 0xff;
+            }
+            continue;
+        }
+        for (x = 0; x < SCREEN_W; x++)
+        {
+            const UWORD *w = line + (x / 16) * v_planes;
+            for (plane = 0, pel = 0; plane < v_planes; plane++)
+                if (w[plane] & (0x8000 >> (x & 15)))
+                    pel |= 1 << plane;
+            *p++ = pel;
+        }
+    }
+
+    return p - buf;
+}
+
+
+static int check_image(const char *refdir, const char *name, BOOL generate)
+{
+    static UBYTE image[SCREEN_W*SCREEN_H+32], ref[SCREEN_W*SCREEN_H+32];
+    char path[MAX_PATH];
+    size_t len, reflen;
+    FILE *fp;
+
+    len = make_image(image);
+    snprintf(path, sizeof(path), "%s/%s-%d.%s", refdir, name, v_planes,
+                (v_planes == 1) ? "pbm" : "pgm");
+
+    if (generate)
+    {
+        fp = fopen(path, "wb");
+        if (!fp || (fwrite(image, 1, len, fp) != len) || fclose(fp))
+        {
+            fprintf(stderr, "vditest: cannot write %s\n", path);
+            exit(2);
+        }
+        printf("%s: written\n", path);
+        return 0;
+    }
+
+    fp = fopen(path, "rb");
+    if (!fp)
+    {
+        printf("%s: missing\n", path);
+        return 1;
+    }
+    reflen = fread(ref, 1, sizeof(ref), fp);
+    fclose(fp);
+
+    if ((reflen != len) || memcmp(image, ref, len))
+    {
+        printf("%s: DIFFERENT\n", path);
+        return 1;
+    }
+
+    return 0;
+}
+
+
+int main(int argc, char **argv)
+{
+    const char *refdir = "tools/vditest";
+    BOOL generate = FALSE;
+    long count = 0, n;
+    int i, errors = 0;
+    unsigned j;
+    WORD planes;
+    clock_t start;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-g"))
+            generate = TRUE;
+        else if (!strcmp(argv[i], "-b") && (i+1 < argc))
+            count = atol(argv[++i]);
+        else if (argv[i][0] == '-')
+        {
+            fprintf(stderr, "usage: vditest [-g] [-b count] [refdir]\n");
+            return 2;
+        }
+        else refdir = argv[i];
+    }
+
+    for (planes = 1; planes <= MAX_PLANES; planes *= 4)
+    {
+        for (j = 0; j < NUM_TESTCASES; j++)
+        {
+            open_screen(planes);
+            (*testcase[j].draw)();
+            errors += check_image(refdir, testcase[j].name, generate);
+
+            if (count <= 0)
+                continue;
+            start = clock();
+            for (n = 0; n < count; n++)
+            {
+                open_screen(planes);
+                (*testcase[j].draw)();
+            }
+            printf("%-8s %d plane%s: %8.3f ms\n", testcase[j].name, planes,
+                (planes == 1) ? " " : "s",
+                (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC / count);
+        }
+    }
+
+    if (!generate)
+        printf("vditest: %d image%s different\n", errors, (errors == 1) ? "" : "s");
+
+    return errors ? 1 : 0;
+}
+
+
+/*
+ * host versions of the functions the drawing code uses from elsewhere
+ */
+
+/* as in vdi/vdi_misc.c */
+UWORD *get_start_addr(const WORD x, const WORD y)
+{
+    static const UBYTE shift_offset[MAX_PLANES+1] = { 0, 3, 2, 0, 1 };
+
+    return (UWORD *)(v_bas_ad + ((x&0xfff0)>>shift_offset[v_planes]) + (LONG)y * v_lin_wr);
+}
+
+void arb_corner(Rect *rect)
+{
+    WORD temp;
+
+    if (rect->x1 > rect->x2)
+    {
+        temp = rect->x1;
+        rect->x1 = rect->x2;
+        rect->x2 = temp;
+    }
+    if (rect->y1 > rect->y2)
+    {
+        temp = rect->y1;
+        rect->y1 = rect->y2;
+        rect->y2 = temp;
+    }
+}
+
+void arb_line(Line *line)
+{
+    WORD temp;
+
+    if (line->x1 > line->x2)
+    {
+        temp = line->x1;
+        line->x1 = line->x2;
+        line->x2 = temp;
+    }
+    if (line->y1 < line->y2)
+    {
+        temp = line->y1;
+        line->y1 = line->y2;
+        line->y2 = temp;
+    }
+}
+
+/* as in vdi/vdi_control.c */
+WORD validate_color_index(WORD colnum)
+{
+    if ((colnum < 0) || (colnum >= numcolors))
+        return 1;
+
+    return colnum;
+}
+
+/* there is no mouse cursor to remove */
+void cur_protect(WORD x1, WORD y1, WORD x2, WORD y2)
+{
+    UNUSED(x1);
+    UNUSED(y1);
+    UNUSED(x2);
+    UNUSED(y2);
+}
+
+/* text output is not linked in */
+void gdp_justified(Vwk *vwk)
+{
+    UNUSED(vwk);
+}
@@ -42,6 +42,8 @@
  */
 
 #define MIN_QUAL 0
+#define MAX_QUAL 7                          /* see v_bez_qual() */
+#define MAX_BEZ_VERTICES ((1<<MAX_QUAL)+1)  /* max vertices per curve */
 #define IS_BEZ(f) ((f&1)!=0)
 #define IS_JUMP(f) ((f&2)!=0)
 
@@ -155,6 +157,45 @@ gen_segs(WORD *const array, WORD *px, const int bez_qual,
 
 
 
+/*
+ * bez_level - choose the number of segments to use for a curve
+ *
+ * if a cubic bezier curve is split into n segments (equally spaced in t),
+ * the segments deviate from the curve by at most 3L/(4n^2), where L is
+ * the larger of the second differences of the control points,
+ * |p0 - 2p1 + p2| and |p1 - 2p2 + p3| (Wang's formula).  we return the
+ * smallest level q such that n = 2^q keeps the deviation within half a
+ * pixel; |dx|+|dy| is used as a cheap upper bound for the lengths.
+ *
+ * the result is limited to the range 0 to max_qual (the workstation's
+ * bezier quality), so small curves get few segments, while large ones
+ * get as many as the quality allows.
+ */
+static WORD
+bez_level(const Point * p, WORD max_qual)
+{
+    LONG l, t;
+    WORD q;
+
+    l = labs((LONG)p[0].x - 2*p[1].x + p[2].x)
+        + labs((LONG)p[0].y - 2*p[1].y + p[2].y);
+    t = labs((LONG)p[1].x - 2*p[2].x + p[3].x)
+        + labs((LONG)p[1].y - 2*p[2].y + p[3].y);
+    if (t > l)
+        l = t;
+
+    /* the deviation is within 1/2 pixel if 2n^2 >= 3L */
+    l *= 3;
+    for (q = 0; q < max_qual; q++) {
+        if ((2L << (2 * q)) >= l)
+            break;
+    }
+
+    return q;
+}
+
+
+
 /*
  * draw_segs - draw segments in xptsin array
  *
@@ -190,7 +231,7 @@ draw_segs(Vwk * vwk, WORD nr_vertices, Point * point, WORD mode)
                 line.x2 = point->x;
                 line.y2 = point->y;
 
-                if (!vwk->clip || clip_line(vwk, &line))
+                if (!vwk->clip || clip_line(VDI_CLIP(vwk), &line))
                     abline(&line, vwk->wrt_mode, vwk->line_color);
             }
         }
@@ -234,12 +275,10 @@ v_bez(Vwk * vwk, Point * ptsget, int nr_ptsin)
     WORD total_vertices = nr_ptsin;
     WORD total_jumps = 0;
     UWORD vertices_per_bez;
-    Point ptsbuf[MAX_PTSIN];
+    Point ptsbuf[MAX_BEZ_VERTICES];     /* only holds one curve at a time */
     /* Point * ptsget = (Point*)PTSIN; */
-    Point * ptsput = ptsbuf;
 
     bez_qual = vwk->bez_qual;
-    vertices_per_bez = 1 << bez_qual;
     xmin = ymin = 32767;
     xmax = ymax = 0;
 
@@ -248,6 +287,8 @@ v_bez(Vwk * vwk, Point * ptsget, int nr_ptsin)
         int flag = bezarr[i^1];         /* index with xor 1 to byte swap !! */
 
         if (IS_BEZ(flag)) {
+            WORD level;
+
             /* bezier start point found */
             if (i+3 >= nr_ptsin)
                 break;                  /* incomlete curve, omit it */
@@ -256,8 +297,10 @@ v_bez(Vwk * vwk, Point * ptsget, int nr_ptsin)
                 total_jumps++;          /* count jump point */
 
             /* generate line segments from bez points */
-            gen_segs(&ptsget->x, &ptsput->x, bez_qual, &xmin, &xmax, vwk->xfm_mode);    /* x coords */
-            gen_segs(&ptsget->y, &ptsput->y, bez_qual, &ymin, &ymax, vwk->xfm_mode);    /* y coords */
+            level = bez_level(ptsget, bez_qual);
+            vertices_per_bez = 1 << level;
+            gen_segs(&ptsget->x, &ptsbuf->x, level, &xmin, &xmax, vwk->xfm_mode);   /* x coords */
+            gen_segs(&ptsget->y, &ptsbuf->y, level, &ymin, &ymax, vwk->xfm_mode);   /* y coords */
 
             /* skip to coord pairs at end of bez curve */
             i += 3;
@@ -322,9 +365,13 @@ v_bez(Vwk * vwk, Point * ptsget, int nr_ptsin)
  * v_bez_fill - draw a filled bezier curve
  *
  * It is similar to v_bez(), but it forms a closed contour and fills
- * it with the current fill pattern.
+ * it with the current fill pattern.  Each disconnected section (starting
+ * at a jump point) is filled separately.
+ *
+ * If a section would exceed the maximum number of vertices, the number
+ * of segments used for the curve that doesn't fit is reduced; if even
+ * that is not enough, the curve (or polyline point) is omitted.
  */
-#if 1
 void
 v_bez_fill(Vwk * vwk, Point * ptsget, int nr_ptsin)
 {
@@ -337,12 +384,12 @@ v_bez_fill(Vwk * vwk, Point * ptsget, int nr_ptsin)
     WORD total_jumps = 0;
     UWORD vertices_per_bez;
     WORD output_vertices = 0;
-    Point ptsbuf[MAX_PTSIN];
+    BOOL end_output = FALSE;            /* end point of last element output */
+    Point ptsbuf[MAX_PTSIN+1];          /* polygon() adds a closing point */
     /* Point * ptsget = (Point*)PTSIN; */
     Point * ptsput = ptsbuf;
 
     bez_qual = vwk->bez_qual;
-    vertices_per_bez = 1 << bez_qual;
     xmin = ymin = 32767;
     xmax = ymax = 0;
 
@@ -350,164 +397,47 @@ v_bez_fill(Vwk * vwk, Point * ptsget, int nr_ptsin)
     while(i < nr_ptsin) {
         int flag = bezarr[i^1]; /* index with xor 1 to byte swap !! */
 
+        /* the start point was output as the end of the previous element */
+        if (end_output) {
+            ptsput--;
+            output_vertices--;
+        }
+        end_output = FALSE;
+
         if (IS_BEZ(flag)) {
+            WORD level;
+
             /* bezier start point found */
             if (i+3 >= nr_ptsin)
-                break;
+                break;                  /* incomplete curve, omit it */
 
             if (IS_JUMP(flag))
-                total_jumps++;   /* count jump point */
+                total_jumps++;          /* count jump point */
 
-            /* generate line segments from bez points */
-            gen_segs(&ptsget->x, &ptsput->x, bez_qual, &xmin, &xmax, vwk->xfm_mode);
-            gen_segs(&ptsget->y, &ptsput->y, bez_qual, &ymin, &ymax, vwk->xfm_mode);
+            /* generate line segments from bez points, if they fit */
+            level = bez_level(ptsget, bez_qual);
+            while ((level > 1) && (output_vertices+(1<<level)+1 > MAX_PTSIN))
+                level--;
+            vertices_per_bez = 1 << level;
+            if (output_vertices+vertices_per_bez+1 <= MAX_PTSIN) {
+                gen_segs(&ptsget->x, &ptsput->x, level, &xmin, &xmax, vwk->xfm_mode);
+                gen_segs(&ptsget->y, &ptsput->y, level, &ymin, &ymax, vwk->xfm_mode);
+                output_vertices += vertices_per_bez+1;
+                ptsput += vertices_per_bez+1;
+                total_vertices += vertices_per_bez-3;
+                end_output = TRUE;
+            }
 
             /* skip to coord pairs at end of bez curve */
             i += 3;
             ptsget += 3;
-            total_vertices += vertices_per_bez-3;
-
-            output_vertices += vertices_per_bez+1;
-            ptsput = ptsbuf + output_vertices;
-            /* draw_segs(vwk, vertices_per_bez+1, ptsbuf, FILL ); */
         }
         else {
             /* polyline */
-            /* WORD output_vertices = 0; */
-            Point * point = ptsget;
             do {
                 int t;
 
-                t = point->x;
-                if ( t < xmin )
-                    xmin = t;
-                if ( t > xmax )
-                    xmax = t;
-
-                t = point->y;
-                if ( t < ymin )
-                    ymin = t;
-                if ( t > ymax )
-                    ymax = t;
-
-                output_vertices++;
-                if ( IS_BEZ(flag) )
-                    break;              /* stop if a jump point is next */
-
-                /* continue polyline */
-                i++;
-                if (i >= nr_ptsin)
-                    break;
-
-                ptsget += 1;
-                {
-                    int old_flag = flag;
-                    flag = bezarr[i^1];
-                    if (!IS_JUMP(old_flag) && IS_JUMP(flag))
-                        total_jumps++;   /* count jump point */
-                }
-            } while( !IS_JUMP(flag) );
-        }
-
-        /* draw segments and reset all vertex information */
-        draw_segs(vwk, output_vertices, ptsbuf, FILL);
-        bez_qual = vwk->bez_qual;
-        /* ptsget0 = ptsget; */
-        ptsput = ptsbuf;
-        output_vertices = 0;
-    }
-
-    INTOUT[0] = total_vertices; /* total nr points */
-    INTOUT[1] = total_jumps;    /* total moves */
-    CONTRL[4] = 2;
-    CONTRL[2] = 2;
-    PTSOUT[0] = xmin;
-    PTSOUT[1] = ymin;
-    PTSOUT[2] = xmax;
-    PTSOUT[3] = ymax;
-
-    return;
-}
-
-#else
-
-void
-v_bez_fill(Vwk * vwk, Point * ptsget, int nr_ptsin)
-{
-    /* WORD  const nr_ptsin = CONTRL[1]; */
-    const UBYTE *const bezarr = (UBYTE*)INTIN;  /* index with xor 1 to byte swap !! */
-    WORD bez_qual;
-    WORD xmin, xmax, ymin, ymax;
-    WORD total_vertices = nr_ptsin;
-    WORD total_jumps = 0;
-    WORD vertices_per_bez;
-    WORD i, i0;
-    WORD output_vertices = 0;
-    Point ptsbuf[MAX_PTSIN];
-    /* Point * ptsget = (Point*)PTSIN; */
-    Point * ptsget0 = ptsget;
-    Point * ptsput = ptsbuf;
-
-    bez_qual = vwk->bez_qual;
-    vertices_per_bez = 1 << bez_qual;
-    xmin = ymin = 32767;
-    xmax = ymax = 0;
-
-    i = i0 = 0;
-    while (i < nr_ptsin) {
-        int flag = bezarr[i^1];
-
-        if (IS_BEZ( flag )) {
-            if (i+3 >= nr_ptsin)
-                break;   /* incomplete curve, omit it */
-
-            if (IS_JUMP(flag))
-                total_jumps++;   /* count jump point */
-
-            /* keep this curve within nr vertices for the driver's ptsget[]
-             ** with one spare for the end point */
-            if ( output_vertices+vertices_per_bez+1 > INQ_TAB[14] ) {
-                if ( bez_qual > MIN_QUAL ) {
-                    /* reduce bezier quality & start this polygon again */
-                    bez_qual--;
-                    i = i0;
-                    ptsget = (Point*)PTSIN;
-                    ptsget0 = ptsget;
-                    ptsput = ptsbuf;
-                    output_vertices = 0;
-                    continue;
-                }
-                /* too bad if we get here. refuse to add vertices to output */
-            }
-            else {
-                if ( i != i0 ) {
-                    /* the end point will be copied in again */
-                    ptsput -= 1;
-                    output_vertices--;
-                }
-
-                output_vertices += vertices_per_bez+1;
-                total_vertices += vertices_per_bez-3;
-                gen_segs(&ptsget->x, &ptsput->x, bez_qual, &xmin, &xmax, vwk->xfm_mode);        /* x coords */
-                gen_segs(&ptsget->y, &ptsput->y, bez_qual, &ymin, &ymax, vwk->xfm_mode);        /* y coords */
-                ptsput = ptsbuf + output_vertices;
-            }
-            /* assert( PTSIN + 2*i == ptsget ); */
-            i+=3;
-            ptsget += 3;
-            flag = bezarr[i^1];
-        }
-        else {
-            /** polyline **/
-            if (i != i0) {
-                /* the end point will be copied in again */
-                ptsput -= 1;
-                output_vertices--;
-            }
-
-            do {
-                int t;
-                if ( output_vertices < INQ_TAB[14] ) {  /* need room for at least one more */
+                if (output_vertices < MAX_PTSIN) {
                     t = ptsget->x;
                     if ( t < xmin )
                         xmin = t;
@@ -524,18 +454,20 @@ v_bez_fill(Vwk * vwk, Point * ptsget, int nr_ptsin)
 
                     ptsput++;
                     output_vertices++;
+                    end_output = TRUE;
+                } else {
+                    end_output = FALSE;
                 }
 
-                /* assert( ptsbuf + output_vertices == ptsput ); */
-                /* assert( PTSIN + 2*i == ptsget ); */
                 if ( IS_BEZ(flag) )
-                    break;
+                    break;              /* stop if a curve is next */
+
+                /* continue polyline */
                 i++;
                 if (i >= nr_ptsin)
                     break;
 
                 ptsget += 1;
-                /* continue polyline, stop if a jump point is next */
                 {
                     int old_flag = flag;
                     flag = bezarr[i^1];
@@ -545,16 +477,18 @@ v_bez_fill(Vwk * vwk, Point * ptsget, int nr_ptsin)
             } while( !IS_JUMP(flag) );
         }
 
-        if ( i >= nr_ptsin || IS_JUMP(flag) ) {
+        /* fill the section if it is complete, and start a new one */
+        if ((i >= nr_ptsin) || IS_JUMP(bezarr[i^1])) {
             draw_segs(vwk, output_vertices, ptsbuf, FILL);
-            bez_qual = vwk->bez_qual;
-            i0 = i;
-            ptsget0 = ptsget;
             ptsput = ptsbuf;
             output_vertices = 0;
+            end_output = FALSE;
         }
     }
 
+    /* fill anything left over after an incomplete curve */
+    draw_segs(vwk, output_vertices, ptsbuf, FILL);
+
     INTOUT[0] = total_vertices; /* total nr points */
     INTOUT[1] = total_jumps;    /* total moves */
     CONTRL[4] = 2;
@@ -565,9 +499,7 @@ v_bez_fill(Vwk * vwk, Point * ptsget, int nr_ptsin)
     PTSOUT[3] = ymax;
 
     return;
-
 }
-#endif
 
 
 /*
@@ -595,16 +527,19 @@ v_bez_control(Vwk * vwk)
  * lower quality bezier curve has fewer longer straight line segments.
  * Higher quality bezier curves thus appear smoother, but are slower.
  *
- * note: bez_qual > 7 will cause overflow in gen_segs()
+ * The quality sets the maximum number of segments per curve: fewer are
+ * used when that is enough to stay within half a pixel of the curve
+ * (see bez_level()).
+ *
+ * note: bez_qual > MAX_QUAL will cause overflow in gen_segs()
  */
-#define MIN_QUAL 0
 static const WORD pcarr[] = {0, 10, 23, 39, 55, 71, 86, 100};
 void
 v_bez_qual(Vwk * vwk)
 {
     int q = INTIN[2];
     if ( q >= 95 )
-        q = 7;
+        q = MAX_QUAL;
     else if ( q<5 )
         q = MIN_QUAL;
     else
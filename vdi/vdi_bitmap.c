@@ -0,0 +1,479 @@
+/*
+ * vdi_bitmap.c - off-screen bitmap workstations
+ *
+ * Copyright 2018 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#include "config.h"
+#include "portab.h"
+#include "asm.h"
+#include "string.h"
+#include "intmath.h"
+#include "vdi_defs.h"
+#include "../bios/lineavars.h"
+#include "../bios/tosvars.h"
+#include "../bios/machine.h"    /* for blitter-related items */
+
+#if CONF_WITH_VDI_EXTENSIONS
+
+/*
+ * An off-screen bitmap workstation is opened by v_opnbm() (opcode 100,
+ * subfunction 1), and draws into a bitmap in ordinary RAM, using the
+ * same interleaved-plane format as the screen.  The drawing code uses
+ * the lineA screen variables, so these are temporarily switched to
+ * describe the bitmap while a function is executed for the workstation
+ * (see bitmap_select() & bitmap_deselect()).
+ *
+ * The areas drawn to are remembered in a small list of dirty rectangles.
+ * v_flushbm() (opcode 251, an EmuTOS extension) copies the dirty areas
+ * to the screen via the raster copy code, and then empties the list.
+ */
+
+#define X_MALLOC 0x48
+#define X_MFREE 0x49
+
+/* screen values saved by bitmap_select() */
+static UBYTE *save_bas_ad;
+static UWORD save_planes, save_lin_wr, save_rez_hz, save_rez_vt;
+static WORD save_xres, save_yres;
+#if CONF_WITH_BLITTER
+static int save_blitter;
+#endif
+
+
+/*
+ * bitmap_init - validate/allocate the bitmap for a v_opnbm() call
+ *
+ * if the MFDB address is NULL, a bitmap is allocated and cleared, and
+ * the MFDB is updated to describe it.  a width, height or number of
+ * planes of zero means 'the same as the screen'.
+ *
+ * returns FALSE if the MFDB is invalid or there is insufficient memory
+ */
+BOOL bitmap_init(Vwk *vwk, MFDB *mfdb)
+{
+    VwkBitmap *bm = (VwkBitmap *)(vwk + 1);
+    WORD planes;
+    LONG size;
+
+    planes = mfdb->fd_nplanes ? mfdb->fd_nplanes : v_planes;
+    if ((planes != 1) && (planes != 2) && (planes != 4) && (planes != 8))
+        return FALSE;
+
+    if (mfdb->fd_addr) {
+        if (mfdb->fd_stand || (mfdb->fd_wdwidth <= 0) || (mfdb->fd_h <= 0))
+            return FALSE;
+        bm->addr = mfdb->fd_addr;
+        bm->width = mfdb->fd_wdwidth * 16;
+        bm->height = mfdb->fd_h;
+        bm->allocated = FALSE;
+    } else {
+        bm->width = ((mfdb->fd_w ? mfdb->fd_w : V_REZ_HZ) + 15) & ~15;
+        bm->height = mfdb->fd_h ? mfdb->fd_h : V_REZ_VT;
+        if ((bm->width <= 0) || (bm->height <= 0))
+            return FALSE;
+        size = (LONG)bm->width / 8 * planes * bm->height;
+        bm->addr = (UBYTE *)trap1(X_MALLOC, size);
+        if (!bm->addr)
+            return FALSE;
+        memset(bm->addr, 0, size);
+        bm->allocated = TRUE;
+
+        mfdb->fd_addr = bm->addr;
+        mfdb->fd_w = bm->width;
+        mfdb->fd_h = bm->height;
+        mfdb->fd_wdwidth = bm->width / 16;
+        mfdb->fd_stand = 0;
+        mfdb->fd_nplanes = planes;
+    }
+
+    bm->planes = planes;
+    bm->lin_wr = bm->width / 8 * planes;
+    bm->num_dirty = 0;
+    vwk->bitmap = bm;
+
+    return TRUE;
+}
+
+
+/*
+ * bitmap_free - free the bitmap memory (if we allocated it)
+ */
+void bitmap_free(Vwk *vwk)
+{
+    if (vwk->bitmap->allocated)
+        trap1(X_MFREE, vwk->bitmap->addr);
+}
+
+
+/*
+ * bitmap_uses_screen - return TRUE iff the function must always use the
+ * screen (input & mouse functions, escapes) or does not draw anything
+ * (workstation close, vector exchanges)
+ */
+BOOL bitmap_uses_screen(WORD opcode)
+{
+    switch(opcode) {
+    case 5:                     /* escapes */
+    case 28:                    /* input functions */
+    case 29:
+    case 30:
+    case 31:
+    case 33:
+    case 101:                   /* v_clsvwk() */
+    case 111:                   /* vsc_form() */
+    case 115:                   /* vqin_mode() */
+    case 118:                   /* vex_timv() */
+    case 122:                   /* v_show_c() */
+    case 123:                   /* v_hide_c() */
+    case 124:                   /* vq_mouse() */
+    case 125:                   /* vex_butv() */
+    case 126:                   /* vex_motv() */
+    case 127:                   /* vex_curv() */
+    case 128:                   /* vq_key_s() */
+    case 134:                   /* vex_wheelv() */
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+
+/*
+ * add_dirty - add a rectangle to the dirty list
+ *
+ * the rectangle is clipped to the bitmap & the clipping rectangle, and
+ * then merged with the first rectangle that it overlaps or touches.  if
+ * there is none and the list is full, it is merged with the rectangle
+ * whose area grows least.
+ */
+static void add_dirty(Vwk *vwk, Rect *rect)
+{
+    VwkBitmap *bm = vwk->bitmap;
+    Rect *r, *best;
+    LONG growth, best_growth;
+    WORD i;
+
+    rect->x1 = max(rect->x1, 0);
+    rect->y1 = max(rect->y1, 0);
+    rect->x2 = min(rect->x2, bm->width - 1);
+    rect->y2 = min(rect->y2, bm->height - 1);
+    if (vwk->clip) {
+        rect->x1 = max(rect->x1, vwk->xmn_clip);
+        rect->y1 = max(rect->y1, vwk->ymn_clip);
+        rect->x2 = min(rect->x2, vwk->xmx_clip);
+        rect->y2 = min(rect->y2, vwk->ymx_clip);
+    }
+    if ((rect->x1 > rect->x2) || (rect->y1 > rect->y2))
+        return;
+
+    for (i = 0, r = bm->dirty; i < bm->num_dirty; i++, r++) {
+        if ((rect->x1 <= r->x2+1) && (r->x1 <= rect->x2+1)
+         && (rect->y1 <= r->y2+1) && (r->y1 <= rect->y2+1))
+            break;
+    }
+
+    if (i >= bm->num_dirty) {
+        if (bm->num_dirty < NUM_DIRTY_RECTS) {
+            bm->dirty[bm->num_dirty++] = *rect;
+            return;
+        }
+        best = bm->dirty;
+        best_growth = 0x7fffffffL;
+        for (i = 0, r = bm->dirty; i < NUM_DIRTY_RECTS; i++, r++) {
+            growth = (LONG)(max(r->x2, rect->x2) - min(r->x1, rect->x1) + 1)
+                        * (max(r->y2, rect->y2) - min(r->y1, rect->y1) + 1)
+                    - (LONG)(r->x2 - r->x1 + 1) * (r->y2 - r->y1 + 1);
+            if (growth < best_growth) {
+                best_growth = growth;
+                best = r;
+            }
+        }
+        r = best;
+    }
+
+    r->x1 = min(r->x1, rect->x1);
+    r->y1 = min(r->y1, rect->y1);
+    r->x2 = max(r->x2, rect->x2);
+    r->y2 = max(r->y2, rect->y2);
+}
+
+
+/*
+ * bounds - set rect to the bounding box of count points, enlarged by margin
+ */
+static void bounds(Rect *rect, const Point *point, WORD count, WORD margin)
+{
+    rect->x1 = rect->x2 = point->x;
+    rect->y1 = rect->y2 = point->y;
+
+    while(--count > 0) {
+        point++;
+        rect->x1 = min(rect->x1, point->x);
+        rect->x2 = max(rect->x2, point->x);
+        rect->y1 = min(rect->y1, point->y);
+        rect->y2 = max(rect->y2, point->y);
+    }
+
+    rect->x1 -= margin;
+    rect->y1 -= margin;
+    rect->x2 += margin;
+    rect->y2 += margin;
+}
+
+
+/*
+ * bitmap_mark - update the dirty list for a function about to be executed
+ *
+ * the area is estimated from the input values before the function is
+ * called.  where this is not easy (e.g. text), the whole clipping area
+ * (or the whole bitmap, if clipping is off) is assumed to be affected.
+ */
+void bitmap_mark(Vwk *vwk, WORD opcode)
+{
+    Point *point = (Point *)PTSIN;
+    Rect rect;
+    WORD xrad, yrad, lw;
+
+    rect.x1 = rect.y1 = 0;
+    rect.x2 = rect.y2 = MAX_COORDINATE;     /* everything */
+    lw = vwk->line_width;
+
+    switch(opcode) {
+    case 3:                     /* v_clrwk() */
+    case 8:                     /* v_gtext() */
+    case 103:                   /* v_contourfill() */
+        break;
+    case 6:                     /* v_pline(), allow for wide lines & arrows */
+        if (CONTRL[N_PTSIN] < 1)
+            return;
+        bounds(&rect, point, CONTRL[N_PTSIN], 3 * lw + 8);
+        break;
+    case 7:                     /* v_pmarker() */
+        if (CONTRL[N_PTSIN] < 1)
+            return;
+        bounds(&rect, point, CONTRL[N_PTSIN], vwk->mark_height);
+        break;
+    case 9:                     /* v_fillarea() */
+        if (CONTRL[N_PTSIN] < 1)
+            return;
+        bounds(&rect, point, CONTRL[N_PTSIN], 1);
+        break;
+    case 114:                   /* vr_recfl() */
+        bounds(&rect, point, 2, 0);
+        break;
+    case 11:                    /* v_gdp() */
+        switch(CONTRL[SUBROUTINE]) {
+        case 1:                 /* v_bar() */
+        case 8:                 /* v_rbox() */
+        case 9:                 /* v_rfbox() */
+            bounds(&rect, point, 2, lw);
+            break;
+        case 2:                 /* v_arc() */
+        case 3:                 /* v_pieslice() */
+        case 4:                 /* v_circle() */
+            xrad = (CONTRL[SUBROUTINE] == 4) ? PTSIN[4] : PTSIN[6];
+            yrad = mul_div(xrad, xsize, ysize);
+            rect.x1 = point->x - xrad - lw;
+            rect.x2 = point->x + xrad + lw;
+            rect.y1 = point->y - yrad - lw;
+            rect.y2 = point->y + yrad + lw;
+            break;
+        case 5:                 /* v_ellipse() */
+        case 6:                 /* v_ellarc() */
+        case 7:                 /* v_ellpie() */
+            rect.x1 = point->x - PTSIN[2] - lw;
+            rect.x2 = point->x + PTSIN[2] + lw;
+            rect.y1 = point->y - PTSIN[3] - lw;
+            rect.y2 = point->y + PTSIN[3] + lw;
+            break;
+        }
+        break;
+    case 109:                   /* vro_cpyfm() */
+    case 121:                   /* vrt_cpyfm() */
+        {
+            MFDB *dst = *(MFDB **)&CONTRL[9];
+            if (dst->fd_addr && (dst->fd_addr != vwk->bitmap->addr))
+                return;
+            bounds(&rect, point+2, 2, 0);
+        }
+        break;
+    case 110:                   /* vr_trnfm() */
+        {
+            MFDB *dst = *(MFDB **)&CONTRL[9];
+            if (dst->fd_addr != vwk->bitmap->addr)
+                return;
+        }
+        break;
+    default:                    /* does not draw */
+        return;
+    }
+
+    add_dirty(vwk, &rect);
+}
+
+
+/*
+ * bitmap_select - switch the lineA screen variables to the bitmap
+ *
+ * mouse drawing by the VBL routine is disabled while the bitmap is
+ * selected, and so is the blitter if the bitmap is not in ST-RAM.
+ */
+void bitmap_select(Vwk *vwk)
+{
+    VwkBitmap *bm = vwk->bitmap;
+
+    mouse_flag += 1;            /* disable mouse redrawing */
+
+    save_bas_ad = v_bas_ad;
+    save_planes = v_planes;
+    save_lin_wr = v_lin_wr;
+    save_rez_hz = V_REZ_HZ;
+    save_rez_vt = V_REZ_VT;
+    save_xres = xres;
+    save_yres = yres;
+
+    v_bas_ad = bm->addr;
+    v_planes = bm->planes;
+    v_lin_wr = bm->lin_wr;
+    V_REZ_HZ = bm->width;
+    V_REZ_VT = bm->height;
+    xres = bm->width - 1;
+    yres = bm->height - 1;
+
+#if CONF_WITH_BLITTER
+    save_blitter = blitter_is_enabled;
+    if (bm->addr + (LONG)bm->lin_wr * bm->height > phystop)
+        blitter_is_enabled = 0;
+#endif
+}
+
+
+/*
+ * bitmap_deselect - restore the lineA screen variables
+ */
+void bitmap_deselect(void)
+{
+    v_bas_ad = save_bas_ad;
+    v_planes = save_planes;
+    v_lin_wr = save_lin_wr;
+    V_REZ_HZ = save_rez_hz;
+    V_REZ_VT = save_rez_vt;
+    xres = save_xres;
+    yres = save_yres;
+
+#if CONF_WITH_BLITTER
+    blitter_is_enabled = save_blitter;
+#endif
+
+    mouse_flag -= 1;            /* re-enable mouse drawing */
+}
+
+
+/*
+ * vdi_v_flushbm - copy the dirty areas of a bitmap to the screen
+ *
+ * This is an EmuTOS extension (opcode 251).  If PTSIN[0],PTSIN[1] are
+ * supplied, they specify the screen position of the top left corner
+ * of the bitmap; otherwise it is 0,0.  As for other VDI output to the
+ * screen, the caller is responsible for hiding the mouse.
+ *
+ * On return, INTOUT[0] contains the number of rectangles copied.
+ */
+void vdi_v_flushbm(Vwk *vwk)
+{
+    VwkBitmap *bm = vwk->bitmap;
+    MFDB src, dst;
+    Rect *r;
+    WORD xoff, yoff, i, count;
+    WORD *save_intin;
+    LONG save_ptr1, save_ptr2;
+    WORD save_clip;
+    VwkClip save_rect, *clip;
+    WORD mode[3];
+
+    count = 0;
+    if (!bm)
+        goto out;
+
+    xoff = yoff = 0;
+    if (CONTRL[N_PTSIN] >= 1) {
+        xoff = PTSIN[0];
+        yoff = PTSIN[1];
+    }
+
+    src.fd_addr = bm->addr;
+    src.fd_w = bm->width;
+    src.fd_h = bm->height;
+    src.fd_wdwidth = bm->width / 16;
+    src.fd_stand = 0;
+    src.fd_nplanes = bm->planes;
+    dst.fd_addr = NULL;         /* screen */
+
+    save_intin = INTIN;
+    save_ptr1 = *(LONG *)&CONTRL[7];
+    save_ptr2 = *(LONG *)&CONTRL[9];
+    *(MFDB **)&CONTRL[7] = &src;
+    *(MFDB **)&CONTRL[9] = &dst;
+    INTIN = mode;
+
+    /*
+     * clip against the screen rather than the bitmap's clip rectangle,
+     * so that an offset or oversized bitmap can't be copied outside it
+     */
+    clip = VDI_CLIP(vwk);
+    save_clip = vwk->clip;
+    save_rect = *clip;
+    vwk->clip = 1;
+    clip->xmn_clip = 0;
+    clip->ymn_clip = 0;
+    clip->xmx_clip = xres;
+    clip->ymx_clip = yres;
+
+#if CONF_WITH_BLITTER
+    save_blitter = blitter_is_enabled;
+    if (bm->addr + (LONG)bm->lin_wr * bm->height > phystop)
+        blitter_is_enabled = 0;
+#endif
+
+    for (i = 0, r = bm->dirty; i < bm->num_dirty; i++, r++) {
+        PTSIN[0] = r->x1;
+        PTSIN[1] = r->y1;
+        PTSIN[2] = r->x2;
+        PTSIN[3] = r->y2;
+        PTSIN[4] = r->x1 + xoff;
+        PTSIN[5] = r->y1 + yoff;
+        PTSIN[6] = r->x2 + xoff;
+        PTSIN[7] = r->y2 + yoff;
+        if (bm->planes == v_planes) {
+            mode[0] = 3;        /* S_ONLY */
+            vdi_vro_cpyfm(vwk);
+        } else if (bm->planes == 1) {
+            mode[0] = MD_REPLACE;
+            mode[1] = 1;        /* black foreground */
+            mode[2] = 0;        /* white background */
+            vdi_vrt_cpyfm(vwk);
+        } else break;           /* unsupported combination */
+        count++;
+    }
+    bm->num_dirty = 0;
+
+#if CONF_WITH_BLITTER
+    blitter_is_enabled = save_blitter;
+#endif
+
+    *clip = save_rect;
+    vwk->clip = save_clip;
+    INTIN = save_intin;
+    *(LONG *)&CONTRL[7] = save_ptr1;
+    *(LONG *)&CONTRL[9] = save_ptr2;
+
+out:
+    CONTRL[N_INTOUT] = 1;
+    INTOUT[0] = count;
+}
+
+#endif /* CONF_WITH_VDI_EXTENSIONS */
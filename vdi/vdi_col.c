@@ -263,11 +263,27 @@ static const WORD ste2vdi_lookup_table[16] =
 #endif
 
 
+#if EXTENDED_PALETTE
+/* Scale a VDI color value (0-1000) to 0-255
+ *
+ * this calculates (col * 255 + 500) / 1000 using a multiply & shift
+ * rather than a division; the result is exact for all values 0-1000
+ */
+static UWORD vdi2byte(UWORD col)
+{
+    return ((ULONG)col * 4178 + 8192) >> 14;
+}
+#endif
+
+
 #if CONF_WITH_TT_SHIFTER
-/* Create a TT color value from VDI color */
+/* Create a TT color value from VDI color
+ *
+ * this calculates (col * 15 + 500) / 1000, as above
+ */
 static int vdi2tt(int col)
 {
-    return (col * 15 + 500) / 1000;
+    return ((ULONG)col * 983 + 32804) >> 16;
 }
 
 
@@ -308,6 +324,29 @@ static WORD adjust_tt_colnum(WORD colnum)
 }
 
 
+/* Convert VDI-style RGB values (0-1000) to a TT hardware palette value */
+static WORD tt_hwvalue(const WORD *rgb, UWORD tt_shifter)
+{
+    WORD r, g, b, grey;
+
+    r = rgb[0];     /* VDI values */
+    g = rgb[1];
+    b = rgb[2];
+
+    if (tt_shifter & TT_HYPER_MONO)
+    {
+        /* we do what TOS3 does: first, derive a weighted value 0-1000
+         * based on input RGB values; then, scale it to a value 0-255
+         * (which the h/w applies to all 3 guns)
+         */
+        grey = mul_div(30,r,100) + mul_div(59,g,100) + mul_div(11,b,100);
+        return mul_div(255,grey,1000);
+    }
+
+    return (vdi2tt(r) << 8) | (vdi2tt(g) << 4) | vdi2tt(b);
+}
+
+
 /* Set an entry in the TT hardware palette
  *
  * TT video hardware has several obscure features which complicate
@@ -317,7 +356,6 @@ static WORD adjust_tt_colnum(WORD colnum)
  */
 static void set_tt_color(WORD colnum, WORD *rgb)
 {
-    WORD r, g, b;
     WORD hwreg, hwvalue;
     UWORD tt_shifter, rez, bank, mask;
 
@@ -355,24 +393,7 @@ static void set_tt_color(WORD colnum, WORD *rgb)
     /*
      * then we determine what value to put in it
      */
-    r = rgb[0];     /* VDI values */
-    g = rgb[1];
-    b = rgb[2];
-
-    if (tt_shifter & TT_HYPER_MONO)
-    {
-        /* we do what TOS3 does: first, derive a weighted value 0-1000
-         * based on input RGB values; then, scale it to a value 0-255
-         * (which the h/w applies to all 3 guns)
-         */
-        hwvalue = mul_div(30,r,100) + mul_div(59,g,100) + mul_div(11,b,100);
-        hwvalue = mul_div(255,hwvalue,1000);
-    }
-    else
-    {
-        hwvalue = (vdi2tt(r) << 8) | (vdi2tt(g) << 4) | vdi2tt(b);
-    }
-    EsetColor(hwreg, hwvalue);
+    EsetColor(hwreg, tt_hwvalue(rgb, tt_shifter));
 }
 
 
@@ -468,10 +489,7 @@ static void query_tt_color(WORD colnum,WORD *retval)
 
 #if CONF_WITH_VIDEL
 /* Create videl colour value from VDI colour */
-static LONG vdi2videl(WORD col)
-{
-    return divu((ULONG)col*255+500, 1000);      /* scale 1000 -> 255 */
-}
+#define vdi2videl(col) ((LONG)vdi2byte(col))
 
 
 /* Create VDI colour value from videl colour */
@@ -546,6 +564,14 @@ static void set_color(WORD colnum, WORD *rgb)
     g = rgb[1];
     b = rgb[2];
 
+#if CONF_WITH_VDI_16BIT
+    if (TRUECOLOR_MODE)         /* no hardware palette in use */
+    {
+        tc_set_color(hwreg, rgb);
+        return;
+    }
+#endif
+
 #if CONF_WITH_VIDEL
     if (has_videl)
     {
@@ -594,13 +620,38 @@ static void set_color(WORD colnum, WORD *rgb)
 }
 
 
+/*
+ * Copy raw values to the "requested colour" arrays, then clamp
+ * them to 0-1000 in rgb[], ready for set_color()
+ */
+static void save_requested(WORD colnum, const WORD *intin, WORD *rgb)
+{
+    WORD i;
+
+    for (i = 0; i < 3; i++, intin++, rgb++)
+    {
+        if (colnum < 16)
+            REQ_COL[colnum][i] = *intin;
+#if EXTENDED_PALETTE
+        else
+            req_col2[colnum-16][i] = *intin;
+#endif
+        if (*intin > 1000)
+            *rgb = 1000;
+        else if (*intin < 0)
+            *rgb = 0;
+        else *rgb = *intin;
+    }
+}
+
+
 /*
  * vdi_vs_color - set color index table
  */
 void vdi_vs_color(Vwk *vwk)
 {
-    WORD colnum, i;
-    WORD *intin, rgb[3], *rgbptr;
+    WORD colnum;
+    WORD rgb[3];
 
     colnum = INTIN[0];
 
@@ -616,28 +667,158 @@ void vdi_vs_color(Vwk *vwk)
         colnum = adjust_tt_colnum(colnum);  /* handles palette bank issues */
 #endif
 
-    /*
-     * Copy raw values to the "requested colour" arrays, then clamp
-     * them to 0-1000 before calling set_color()
-     */
-    for (i = 0, intin = INTIN+1, rgbptr = rgb; i < 3; i++, intin++, rgbptr++)
+    save_requested(colnum, INTIN+1, rgb);
+
+    colnum = INTIN[0];      /* may have been munged on TT system, see above */
+    set_color(colnum, rgb);
+}
+
+
+#if CONF_WITH_VDI_EXTENSIONS
+#if EXTENDED_PALETTE
+/*
+ * buffer for the hardware palette values of a range of registers;
+ * Falcon values are LONGs, TT values are WORDs
+ */
+static ULONG hw_palette[MAXCOLOURS];
+
+/*
+ * hw_range - find the range of hardware registers used by a range of pens
+ */
+static void hw_range(WORD first, WORD count, WORD mask, WORD offset, WORD *lo, WORD *hi)
+{
+    WORD colnum, hwreg;
+
+    *lo = MAXCOLOURS - 1;
+    *hi = 0;
+    for (colnum = first; colnum < first+count; colnum++)
     {
-        if (colnum < 16)
-            REQ_COL[colnum][i] = *intin;
+        hwreg = (MAP_COL[colnum] & mask) + offset;
+        if (hwreg < *lo)
+            *lo = hwreg;
+        if (hwreg > *hi)
+            *hi = hwreg;
+    }
+}
+
+
+/*
+ * set_hw_colors - set a range of pens via a single XBIOS call
+ *
+ * the pens map to a (possibly non-contiguous) set of hardware registers,
+ * so we read the range that covers them, update the values, and write
+ * the range back.  returns FALSE if this isn't possible for the current
+ * video hardware and mode, in which case set_color() must be used.
+ */
+static BOOL set_hw_colors(WORD first, WORD count, const WORD *intin)
+{
+    WORD colnum, lo, hi, rgb[3];
+
+    if (TRUECOLOR_MODE)         /* no hardware palette in use */
+        return FALSE;
+
+#if CONF_WITH_VIDEL
+    if (has_videl)
+    {
+        hw_range(first, count, 0xff, 0, &lo, &hi);
+        VgetRGB(lo, hi-lo+1, (LONG)&hw_palette[lo]);
+        for (colnum = first; colnum < first+count; colnum++, intin += 3)
+        {
+            save_requested(colnum, intin, rgb);
+            hw_palette[MAP_COL[colnum]] = (vdi2videl(rgb[0]) << 16)
+                                | (vdi2videl(rgb[1]) << 8) | vdi2videl(rgb[2]);
+        }
+        VsetRGB(lo, hi-lo+1, (LONG)&hw_palette[lo]);    /* updated at next VBL */
+        return TRUE;
+    }
+#endif
+
+#if CONF_WITH_TT_SHIFTER
+    if (has_tt_shifter)
+    {
+        UWORD *ttpal = (UWORD *)hw_palette;
+        UWORD tt_shifter = EgetShift();
+        WORD mask = 0xff, offset = 0;
+
+        switch((tt_shifter>>8) & 0x07) {
+        case ST_LOW:
+        case ST_MEDIUM:
+        case TT_MEDIUM:
+            mask = numcolors - 1;
+            offset = (tt_shifter & 0x000f) * 16;    /* allow for bank number */
+            break;
+        case TT_LOW:
+            break;
+        default:                /* duochrome & TT high need special handling */
+            return FALSE;
+        }
+
+        hw_range(first, count, mask, offset, &lo, &hi);
+        EgetPalette(lo, hi-lo+1, (LONG)&ttpal[lo]);
+        for (colnum = first; colnum < first+count; colnum++, intin += 3)
+        {
+            save_requested(colnum+offset, intin, rgb);
+            ttpal[(MAP_COL[colnum]&mask)+offset] = tt_hwvalue(rgb, tt_shifter);
+        }
+        EsetPalette(lo, hi-lo+1, (LONG)&ttpal[lo]);
+        return TRUE;
+    }
+#endif
+
+    return FALSE;
+}
+#endif
+
+
+/*
+ * vdi_vs_colors - set a range of colors
+ *
+ * This is an EmuTOS extension (opcode 252), intended for programs that
+ * change many pens at once, e.g. for palette animation.  It is equivalent
+ * to calling vs_color() for each pen, but on Falcon and TT systems all
+ * the hardware palette registers are written by a single XBIOS call (on
+ * the Falcon, at the next VBL).
+ *
+ *  INTIN[0]    first pen
+ *  INTIN[1]    number of pens
+ *  INTIN[2-]   red, green, blue values (0-1000) for each pen
+ *
+ * Pens beyond the number of colors available are ignored.  On return,
+ * INTOUT[0] contains the number of pens set.
+ */
+void vdi_vs_colors(Vwk *vwk)
+{
+    WORD first, count, colnum, rgb[3];
+    const WORD *intin;
+
+    first = INTIN[0];
+    count = INTIN[1];
+
+    if ((first < 0) || (first >= numcolors) || (count < 0))
+        count = 0;
+    else if (count > numcolors - first)
+        count = numcolors - first;
+
+    INTOUT[0] = count;
+    CONTRL[N_INTOUT] = 1;
+
 #if EXTENDED_PALETTE
+    if (count && set_hw_colors(first, count, INTIN+2))
+        return;
+#endif
+
+    for (colnum = first, intin = INTIN+2; colnum < first+count; colnum++, intin += 3)
+    {
+#if CONF_WITH_TT_SHIFTER
+        if (has_tt_shifter)
+            save_requested(adjust_tt_colnum(colnum), intin, rgb);
         else
-            req_col2[colnum-16][i] = *intin;
 #endif
-        if (*intin > 1000)
-            *rgbptr = 1000;
-        else if (*intin < 0)
-            *rgbptr = 0;
-        else *rgbptr = *intin;
+        save_requested(colnum, intin, rgb);
+        set_color(colnum, rgb);
     }
-
-    colnum = INTIN[0];      /* may have been munged on TT system, see above */
-    set_color(colnum, rgb);
 }
+#endif
 
 
 /* Set the default palette etc. */
@@ -186,12 +186,31 @@ WORD validate_color_index(WORD colnum)
 
 
 
-/* Set Clip Region */
+/*
+ * Set Clip Region
+ *
+ * As an EmuTOS extension, if clipping is being turned on and more than
+ * one rectangle (two points) is passed in PTSIN, the workstation clips
+ * to all of the rectangles (see vdi_region.c).  In that case, INTOUT[0]
+ * returns the number of rectangles actually used; other VDIs just use
+ * the first rectangle, and return nothing.
+ */
 void vdi_vs_clip(Vwk * vwk)
 {
     vwk->clip = INTIN[0];
+#if CONF_WITH_VDI_EXTENSIONS
+    vwk->region.count = 0;
+#endif
     if (vwk->clip) {
         Rect * rect = (Rect*)PTSIN;
+#if CONF_WITH_VDI_EXTENSIONS
+        if (CONTRL[N_PTSIN] > 2) {
+            INTOUT[0] = region_set(vwk, rect, CONTRL[N_PTSIN] / 2);
+            CONTRL[N_INTOUT] = 1;
+            if (INTOUT[0])
+                return;
+        }
+#endif
         arb_corner(rect);
         vwk->xmn_clip = max(0, rect->x1);
         vwk->ymn_clip = max(0, rect->y1);
@@ -284,6 +303,9 @@ static void init_wk(Vwk * vwk)
     vwk->xmx_clip = xres;
     vwk->ymx_clip = yres;
     vwk->clip = FALSE;
+#if CONF_WITH_VDI_EXTENSIONS
+    vwk->region.count = 0;
+#endif
 
     text_init2(vwk);
 
@@ -343,17 +365,49 @@ void vdi_v_opnvwk(Vwk * vwk)
         return;
     }
 
+#if CONF_WITH_VDI_EXTENSIONS
+    /*
+     * v_opnbm(): open an off-screen bitmap workstation.  The Vwk and
+     * the VwkBitmap that describes the bitmap are allocated together.
+     */
+    if (CONTRL[SUBROUTINE] == 1) {
+        vwk = (Vwk *)trap1(X_MALLOC, sizeof(Vwk) + sizeof(VwkBitmap));
+        if (vwk == NULL) {
+            vwk_ptr[handle] = NULL;
+            CONTRL[6] = 0;  /* No memory available, exit */
+            return;
+        }
+        if (!bitmap_init(vwk, *(MFDB **)&CONTRL[7])) {
+            trap1(X_MFREE, vwk);
+            vwk_ptr[handle] = NULL;
+            CONTRL[6] = 0;  /* invalid MFDB or no memory for bitmap */
+            return;
+        }
+        vwk_ptr[handle] = vwk;
+        vwk->handle = CONTRL[6] = handle;
+        bitmap_select(vwk);     /* so that clipping etc reflect the bitmap */
+        init_wk(vwk);
+        bitmap_deselect();
+        CUR_WORK = vwk;
+        return;
+    }
+#endif
+
     /*
      * Allocate the memory for a virtual workstation
      */
     vwk = (Vwk *)trap1(X_MALLOC, sizeof(Vwk));
     if (vwk == NULL) {
+        vwk_ptr[handle] = NULL;
         CONTRL[6] = 0;  /* No memory available, exit */
         return;
     }
 
     vwk_ptr[handle] = vwk;
     vwk->handle = CONTRL[6] = handle;
+#if CONF_WITH_VDI_EXTENSIONS
+    vwk->bitmap = NULL;
+#endif
     init_wk(vwk);
     CUR_WORK = vwk;
 }
@@ -384,6 +438,10 @@ void vdi_v_clsvwk(Vwk * vwk)
      */
     CUR_WORK = &phys_work;
 
+#if CONF_WITH_VDI_EXTENSIONS
+    if (vwk->bitmap)                /* v_clsbm() */
+        bitmap_free(vwk);
+#endif
     trap1(X_MFREE, vwk);
 }
 
@@ -473,6 +531,10 @@ void vdi_v_clswk(Vwk * vwk)
     /* close all open virtual workstations */
     for (handle = VDI_PHYS_HANDLE+1, p = vwk_ptr+handle; handle <= LAST_VDI_HANDLE; handle++, p++) {
         if (*p) {
+#if CONF_WITH_VDI_EXTENSIONS
+            if ((*p)->bitmap)
+                bitmap_free(*p);
+#endif
             trap1(X_MFREE, *p);
             *p = NULL;
         }
@@ -498,7 +560,15 @@ void vdi_v_clrwk(Vwk * vwk)
     /* Calculate screen size */
     size = (ULONG)v_lin_wr * V_REZ_VT;
 
+    cur_protect(0, 0, xres, yres);
+
     /* clear the screen */
+#if CONF_WITH_VDI_16BIT
+    if (TRUECOLOR_MODE) {
+        tc_clear();
+        return;
+    }
+#endif
     memset(v_bas_ad, 0, size);
 }
 
@@ -86,6 +86,11 @@
 #define SUBROUTINE  5
 #define VDI_HANDLE  6
 
+/* opcodes of EmuTOS extensions */
+#define V_BATCH     250         /* v_batch(), see vdi_main.c */
+#define V_FLUSHBM   251         /* v_flushbm(), see vdi_bitmap.c */
+#define VS_COLORS   252         /* vs_colors(), see vdi_col.c */
+
 /* gsx write modes */
 #define MD_REPLACE  1
 #define MD_TRANS    2
@@ -115,6 +120,20 @@ typedef struct {
 } VwkAttrib;
 
 
+/* Raster definitions */
+typedef struct {
+    void *fd_addr;
+    WORD fd_w;
+    WORD fd_h;
+    WORD fd_wdwidth;
+    WORD fd_stand;
+    WORD fd_nplanes;
+    WORD fd_r1;
+    WORD fd_r2;
+    WORD fd_r3;
+} MFDB;
+
+
 /* type that can be cast from clipping part of Wvk */
 typedef struct {
     WORD xmn_clip;              /* Low x point of clipping rectangle    */
@@ -126,6 +145,35 @@ typedef struct {
 #define VDI_CLIP(wvk) ((VwkClip*)(&(wvk->xmn_clip)))
 
 
+/* Off-screen bitmap information, for workstations opened by v_opnbm() */
+#define NUM_DIRTY_RECTS 8       /* max # of dirty rectangles tracked */
+
+typedef struct {
+    WORD x1,y1;
+    WORD x2,y2;
+} Rect;
+
+typedef struct {
+    UBYTE *addr;                /* start of bitmap */
+    WORD width;                 /* width in pixels (multiple of 16) */
+    WORD height;                /* height in pixels */
+    WORD planes;                /* number of (interleaved) planes */
+    WORD lin_wr;                /* bytes per line */
+    BOOL allocated;             /* TRUE iff the VDI allocated the bitmap */
+    WORD num_dirty;             /* number of entries used in dirty[] */
+    Rect dirty[NUM_DIRTY_RECTS];/* areas drawn since the last v_flushbm() */
+} VwkBitmap;
+
+
+/* Clip region, set by vs_clip() with a list of rectangles */
+#define MAX_CLIP_RECTS  32      /* max # of rectangles in a clip region */
+
+typedef struct {
+    WORD count;                 /* 0 => clip to a single rectangle */
+    VwkClip rect[MAX_CLIP_RECTS];/* sorted by upper edge, then left edge */
+} ClipRegion;
+
+
 /* Structure to hold data for a virtual workstation */
 
 /* NOTE 1: for backwards compatibility with all versions of TOS, the
@@ -181,14 +229,12 @@ struct Vwk_ {
     WORD ymx_clip;              /* High y point of clipping rectangle   */
     /* newly added */
     WORD bez_qual;              /* actual quality for bezier curves */
+#if CONF_WITH_VDI_EXTENSIONS
+    VwkBitmap *bitmap;          /* off-screen bitmap, NULL for the screen */
+    ClipRegion region;          /* clip region, see vdi_region.c */
+#endif
 };
 
-
-typedef struct {
-    WORD x1,y1;
-    WORD x2,y2;
-} Rect;
-
 typedef struct {
     WORD x1,y1;
     WORD x2,y2;
@@ -253,13 +299,14 @@ void put_pix(void);
 void linea_show_mouse(void);
 void linea_hide_mouse(void);
 void linea_transform_mouse(void);
+void cur_protect(WORD x1, WORD y1, WORD x2, WORD y2);
 
 
 /* Assembly Language Support Routines, ignore workstation arg */
 void text_blt(void);
 void rectfill (Vwk * vwk, Rect * rect);
 
-BOOL clip_line(Vwk * vwk, Line * line);
+BOOL clip_line(const VwkClip * clip, Line * line);
 void arb_corner(Rect * rect);
 void arb_line(Line * line);
 
@@ -284,6 +331,8 @@ void wideline(Vwk * vwk, Point * point, int count);
 void Vwk2Attrib(const Vwk *vwk, VwkAttrib *attr, const UWORD color);
 void draw_rect_common(const VwkAttrib *attr, const Rect *rect);
 void clc_flit (const VwkAttrib * attr, const VwkClip * clipper, const Point * point, WORD y, int vectors);
+void draw_span(const VwkAttrib * attr, const VwkClip * clipper, WORD x1, WORD x2, WORD y);
+BOOL clipbox(const VwkClip * clip, Rect * rect);
 void abline (const Line * line, const WORD wrt_mode, UWORD color);
 void contourfill(const VwkAttrib * attr, const VwkClip *clip);
 
@@ -299,6 +348,77 @@ void vdimouse_exit(void);
 void timer_exit(void);
 void esc_exit(Vwk *);
 
+#if CONF_WITH_VDI_EXTENSIONS
+/* off-screen bitmap support */
+BOOL bitmap_init(Vwk *vwk, MFDB *mfdb);
+void bitmap_free(Vwk *vwk);
+BOOL bitmap_uses_screen(WORD opcode);
+void bitmap_mark(Vwk *vwk, WORD opcode);
+void bitmap_select(Vwk *vwk);
+void bitmap_deselect(void);
+void vdi_v_flushbm(Vwk *vwk);
+
+/* bulk palette update */
+void vdi_vs_colors(Vwk *vwk);
+
+/* clip regions */
+#define REGION_ONCE     0       /* function is not affected by the region */
+#define REGION_SPLIT    1       /* output is split by the primitives */
+#define REGION_REPEAT   2       /* function is called once per rectangle */
+extern const ClipRegion *cur_region;
+WORD region_set(Vwk *vwk, Rect *rect, WORD count);
+WORD region_mode(WORD opcode, WORD subfunction);
+BOOL region_contains(WORD x, WORD y);
+void region_draw_rect(const VwkAttrib *attr, const Rect *rect);
+void region_abline(const Line *line, WORD wrt_mode, UWORD color);
+#endif
+
+#if CONF_WITH_BLITTER
+/* blitter synchronisation, see vdi_line.c */
+void blit_end(void *addr, LONG length);
+#endif
+#if CONF_WITH_BLITTER && CONF_WITH_VDI_ASYNC_BLIT
+extern BOOL blit_async;
+void blit_sync(void);
+#else
+#define blit_sync()
+#endif
+
+#if CONF_WITH_VDI_16BIT
+/* 16-bit (pixel-packed) video modes, see vdi_truecolor.c */
+#define TRUECOLOR_MODE  (v_planes == 16)
+extern UWORD tc_palette[256];
+void tc_set_color(WORD hwreg, const WORD *rgb);
+void tc_draw_rect(const VwkAttrib *attr, const Rect *rect);
+void tc_draw_line(const Line *line, WORD wrt_mode, UWORD color);
+void tc_clear(void);
+#else
+#define TRUECOLOR_MODE  0
+#endif
+
+#if CONF_WITH_VDI_PROFILE
+/* VDI performance counters, see vdi_profile.c */
+typedef struct {
+    UWORD opcode;
+    UWORD reserved;
+    ULONG calls;                /* number of calls */
+    ULONG pixels;               /* number of pixels written */
+    ULONG time;                 /* elapsed time, in units of 1/38400 sec */
+} VdiProfile;
+
+typedef struct {
+    ULONG pixels;
+    ULONG time;
+} ProfileStart;
+
+extern ULONG vdi_pixels;
+
+BOOL vdi_profiling(void);
+void profile_begin(ProfileStart *start);
+void profile_end(WORD opcode, const ProfileStart *start);
+void vdi_v_profile(Vwk *vwk);
+#endif
+
 /* all VDI functions */
 
 /* As reference the TOS 1.0 start addresses are added */
@@ -20,6 +20,7 @@
 /* Local Constants */
 
 #define ldri_escape             19      /* last DRI escape = 19. */
+#define ESC_PROFILE             2000    /* EmuTOS extension, see vdi_profile.c */
 
 #define X_RAWIO  0x06
 #define X_CONWS  0x09
@@ -334,6 +335,13 @@ void vdi_v_escape(Vwk * vwk)
     }
 #endif
 
+#if CONF_WITH_VDI_PROFILE
+    if (escfun == ESC_PROFILE) {
+        vdi_v_profile(vwk);     /* control performance counters */
+        return;
+    }
+#endif
+
     if (escfun > ldri_escape)
         return;
     (*esctbl[escfun])(vwk);
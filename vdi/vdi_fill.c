@@ -17,8 +17,8 @@
 #include "../bios/tosvars.h"
 #include "../bios/lineavars.h"
 
-#define EMPTY   0xffff
-#define DOWN_FLAG 0x8000
+#define EMPTY   ((WORD)0xffff)
+#define DOWN_FLAG ((WORD)0x8000)
 #define QSIZE 200
 #define QMAX QSIZE-1
 
@@ -28,7 +28,6 @@
 
 /* prototypes */
 static void crunch_queue(void);
-static BOOL clipbox(const VwkClip * clip, Rect * rect);
 
 
 
@@ -534,6 +533,34 @@ clc_flit (const VwkAttrib * attr, const VwkClip * clipper, const Point * point,
 
 
 
+/*
+ * draw_span - draw one horizontal span of a filled shape
+ *
+ * The span (x1->x2 on line y) is clipped against the clipping rectangle,
+ * which always lies within the screen, and is then drawn with the fill
+ * attributes.  This is used by the span-based wideline and ellipse code,
+ * which generates the spans of a shape directly.
+ */
+void draw_span(const VwkAttrib * attr, const VwkClip * clipper, WORD x1, WORD x2, WORD y)
+{
+    Rect rect;
+
+    if ((y < clipper->ymn_clip) || (y > clipper->ymx_clip))
+        return;
+    if (x1 < clipper->xmn_clip)
+        x1 = clipper->xmn_clip;
+    if (x2 > clipper->xmx_clip)
+        x2 = clipper->xmx_clip;
+    if (x1 > x2)
+        return;
+
+    rect.x1 = x1;
+    rect.y1 = y;
+    rect.x2 = x2;
+    rect.y2 = y;
+    draw_rect_common(attr, &rect);
+}
+
 /*
  * polygon - draw a filled polygon
  */
@@ -644,7 +671,7 @@ void vdi_v_fillarea(Vwk * vwk)
  *         ->x2 = x coord of lower right corner.
  *         ->y2 = y coord of lower right corner.
  */
-static BOOL
+BOOL
 clipbox(const VwkClip * clip, Rect * rect)
 {
     WORD x1, y1, x2, y2;
@@ -723,6 +750,8 @@ pixelread(const WORD x, const WORD y)
     UWORD *addr;
     UWORD mask;
 
+    blit_sync();                        /* we're about to read the screen */
+
     /* convert x,y to start address and bit mask */
     addr = get_start_addr(x, y);
     addr += v_planes;                   /* start at highest-order bit_plane */
@@ -810,6 +839,9 @@ end_pts(const VwkClip * clip, WORD x, WORD y, WORD *xleftout, WORD *xrightout,
     if ( y < clip->ymn_clip || y > clip->ymx_clip)
         return 0;
 
+    /* the previous span may still be being drawn by the blitter */
+    blit_sync();
+
     /* convert x,y to start address and bit mask */
     addr = get_start_addr(x, y);
     addr += v_planes;                   /* start at highest-order bit_plane */
@@ -961,7 +993,7 @@ void contourfill(const VwkAttrib * attr, const VwkClip *clip)
 static void
 crunch_queue(void)
 {
-    while ((queue[qtop - 3] == EMPTY) && (qtop > qbottom))
+    while ((qtop > qbottom) && (queue[qtop - 3] == EMPTY))
         qtop -= 3;
     if (qptr >= qtop)
         qptr = qbottom;
@@ -1045,7 +1077,13 @@ void vdi_v_contourfill(Vwk * vwk)
 {
     VwkAttrib attr;
 
+#if CONF_WITH_VDI_EXTENSIONS
+    if (cur_region && !region_contains(PTSIN[0], PTSIN[1]))
+        return;                     /* seed point is outside the region */
+#endif
+
     SEEDABORT = no_abort;
+    cur_protect(0, 0, xres, yres);  /* we don't know how far the fill goes */
     Vwk2Attrib(vwk, &attr, vwk->fill_color);
     contourfill(&attr, VDI_CLIP(vwk));
 }
@@ -1058,6 +1096,8 @@ void vdi_v_get_pixel(Vwk * vwk)
     const WORD x = PTSIN[0];       /* fetch x coord. */
     const WORD y = PTSIN[1];       /* fetch y coord. */
 
+    cur_protect(x, y, x, y);
+
     /* Get the requested pixel */
     pel = (WORD)pixelread(x,y);
 
@@ -132,6 +132,44 @@ static void clc_pts(Point *point, WORD angle)
 
 
 
+/*
+ * fill_ellipse - fills a circle/ellipse, centred on xc/yc with radii xrad/yrad
+ *
+ * Rather than filling the polygon approximating the ellipse (which means
+ * intersecting every scan line with up to MAX_ARC_CT edges), we calculate
+ * the half-width of each pair of spans directly and draw them.  Like the
+ * polygon code, the spans do not include the boundary of the ellipse,
+ * which is drawn separately as the perimeter if required.
+ */
+static void fill_ellipse(Vwk * vwk)
+{
+    VwkAttrib attr;
+    const VwkClip *clipper;
+    WORD dy, dx;
+    LONG yrad2;
+
+    if ((xrad <= 0) || (yrad <= 0))
+        return;
+
+    clipper = VDI_CLIP(vwk);
+    Vwk2Attrib(vwk, &attr, vwk->fill_color);
+    yrad2 = (LONG)yrad * yrad;
+
+    for (dy = 0; dy < yrad; dy++) {
+        /* dx = xrad * sqrt(1 - dy^2/yrad^2), less 1 for the boundary */
+        dx = (LONG)xrad * Isqrt(yrad2 - (LONG)dy * dy) / yrad - 1;
+        if (dx < 0)
+            break;
+        if ((dy > yc - clipper->ymn_clip) && (dy > clipper->ymx_clip - yc))
+            break;              /* both spans (and all later ones) clipped */
+        draw_span(&attr, clipper, xc - dx, xc + dx, yc + dy);
+        if (dy)
+            draw_span(&attr, clipper, xc - dx, xc + dx, yc - dy);
+    }
+}
+
+
+
 /*
  * clc_arc - calculates the positions of all the points necessary to draw
  *           a circular/elliptical arc (or a circle/ellipse), and draws it
@@ -176,6 +214,14 @@ static void clc_arc(Vwk * vwk, int steps)
         } else
             wideline(vwk, point, steps);
     }
+    else if ((CONTRL[5] == 4) || (CONTRL[5] == 5)) {  /* v_circle()/v_ellipse() */
+        LSTLIN = FALSE;
+        fill_ellipse(vwk);
+        if (vwk->fill_per == TRUE) {
+            LN_MASK = 0xffff;
+            polyline(vwk, point, steps, vwk->fill_color);
+        }
+    }
     else
         polygon(vwk, point, steps);
 }
@@ -49,6 +49,86 @@ typedef struct
  */
 const UBYTE op_draw[] = { 0x03, 0x07, 0x06, 0x0d };
 const UBYTE op_nodraw[] = { 0x00, 0x04, 0x06, 0x01 };
+
+
+/*
+ * blitter synchronisation
+ *
+ * We run the blitter in the Atari-recommended way: use no-HOG mode, and
+ * manually restart the blitter until it's done (see blit_wait()).
+ *
+ * If CONF_WITH_VDI_ASYNC_BLIT is set, blit_end() does not wait for the
+ * last blit of a primitive while a VDI function is being executed
+ * (blit_async is TRUE).  The blitter then carries on, sharing the bus
+ * with the CPU, which can meanwhile set up the next primitive.  Anything
+ * that accesses the blitter registers or the screen must therefore call
+ * blit_sync() first.  The VDI dispatcher calls it before all functions
+ * except the ones that only draw via draw_rect_common() & abline(), and
+ * before returning to the caller, so programs that access the screen
+ * directly never see an unfinished blit.  Line-A functions are not
+ * affected, since blit_async is FALSE when they are called.
+ *
+ * Note that a function which reads the screen while drawing must also
+ * call blit_sync() before each read: v_contourfill() draws each span as
+ * it goes, and looks at the pixels next to it (see end_pts()).
+ */
+#if CONF_WITH_VDI_ASYNC_BLIT
+BOOL blit_async;                /* TRUE iff a blit may be left running */
+static BOOL blit_pending;       /* TRUE iff a blit may still be running */
+static void *pending_addr;      /* area being modified by it */
+static LONG pending_length;
+#endif
+
+static void blit_wait(void)
+{
+    __asm__ __volatile__(
+    "lea    0xFFFF8A3C,a0\n\t"
+    "0:\n\t"
+    "tas    (a0)\n\t"
+    "nop\n\t"
+    "jbmi   0b\n\t"
+    :
+    :
+    : "a0", "memory", "cc"
+    );
+}
+
+#if CONF_WITH_VDI_ASYNC_BLIT
+/*
+ * blit_sync - wait for a blit left running by blit_end()
+ */
+void blit_sync(void)
+{
+    if (!blit_pending)
+        return;
+
+    blit_wait();
+    invalidate_data_cache(pending_addr, pending_length);
+    blit_pending = FALSE;
+}
+#endif
+
+/*
+ * blit_end - finish the last blit of a primitive
+ *
+ * the blitter has modified the specified area behind the cpu's back,
+ * so any cached data for it must be invalidated when it has finished
+ */
+void blit_end(void *addr, LONG length)
+{
+#if CONF_WITH_VDI_ASYNC_BLIT
+    if (blit_async)
+    {
+        pending_addr = addr;
+        pending_length = length;
+        blit_pending = TRUE;
+        return;
+    }
+#endif
+
+    blit_wait();
+    invalidate_data_cache(addr, length);
+}
 #endif
 
 
@@ -191,6 +271,8 @@ static BOOL blit_vline(const Line *line, WORD wrt_mode, UWORD color)
     dy = line->y2 - line->y1;
     yinc = v_lin_wr;
 
+    blit_sync();
+
     if (dy >= 0)
     {
         for (i = 0, mask = 0x8000; i < 16; i++, mask >>= 1)
@@ -233,27 +315,15 @@ static BOOL blit_vline(const Line *line, WORD wrt_mode, UWORD color)
         BLITTER->y_count = dy + 1;
         BLITTER->op = (color & 1) ? op_draw[wrt_mode]: op_nodraw[wrt_mode];
 
-        /*
-         * we run the blitter in the Atari-recommended way: use no-HOG mode,
-         * and manually restart the blitter until it's done.
-         */
         BLITTER->status = BUSY | start_line;    /* no-HOG mode */
-        __asm__ __volatile__(
-        "lea    0xFFFF8A3C,a0\n\t"
-        "0:\n\t"
-        "tas    (a0)\n\t"
-        "nop\n\t"
-        "jbmi   0b\n\t"
-        :
-        :
-        : "a0", "memory", "cc"
-        );
+        if (plane < v_planes - 1)
+            blit_wait();        /* the next plane needs the blitter */
     }
     /*
      * we've modified the screen behind the cpu's back, so we must
-     * invalidate any cached screen data.
+     * invalidate any cached screen data (when the blitter has finished).
      */
-    invalidate_data_cache(screen_addr, size);
+    blit_end(screen_addr, size);
 
     /* update LN_MASK for next time */
     mask = LN_MASK;
@@ -283,6 +353,7 @@ static BOOL blit_hline(const VwkAttrib *attr, const Rect *rect, BLITPARM *b)
      * is overkill, but note that the current cache control routines
      * ignore the length specification & act on the whole cache anyway.
      */
+    blit_sync();
     flush_data_cache(b->addr, v_lin_wr);
 
     BLITTER->src_x_incr = 0;
@@ -306,27 +377,15 @@ static BOOL blit_hline(const VwkAttrib *attr, const Rect *rect, BLITPARM *b)
         BLITTER->y_count = 1;
         BLITTER->op = (color & 1) ? op_draw[attr->wrt_mode]: op_nodraw[attr->wrt_mode];
 
-        /*
-         * we run the blitter in the Atari-recommended way: use no-HOG mode,
-         * and manually restart the blitter until it's done.
-         */
         BLITTER->status = BUSY;     /* no-HOG mode */
-        __asm__ __volatile__(
-        "lea    0xFFFF8A3C,a0\n\t"
-        "0:\n\t"
-        "tas    (a0)\n\t"
-        "nop\n\t"
-        "jbmi   0b\n\t"
-        :
-        :
-        : "a0", "memory", "cc"
-        );
+        if (plane < v_planes - 1)
+            blit_wait();        /* the next plane needs the blitter */
     }
     /*
      * we've modified a screen line behind the cpu's back, so we must
-     * invalidate any cached screen data.
+     * invalidate any cached screen data (when the blitter has finished).
      */
-    invalidate_data_cache(b->addr,v_lin_wr);
+    blit_end(b->addr, v_lin_wr);
 
     return TRUE;
 }
@@ -358,6 +417,7 @@ static BOOL blit_rect_common(const VwkAttrib *attr, const Rect *rect, BLITPARM *
     /*
      * flush the data cache to ensure that the screen memory is current
      */
+    blit_sync();
     flush_data_cache(b->addr, v_lin_wr*ycount);
 
     BLITTER->src_x_incr = 0;
@@ -389,27 +449,15 @@ static BOOL blit_rect_common(const VwkAttrib *attr, const Rect *rect, BLITPARM *
         BLITTER->hop = HOP_HALFTONE_ONLY;
         BLITTER->op = (color & 1) ? op_draw[attr->wrt_mode]: op_nodraw[attr->wrt_mode];
 
-        /*
-         * we run the blitter in the Atari-recommended way: use no-HOG mode,
-         * and manually restart the blitter until it's done.
-         */
         BLITTER->status = status;
-        __asm__ __volatile__(
-        "lea    0xFFFF8A3C,a0\n\t"
-        "0:\n\t"
-        "tas    (a0)\n\t"
-        "nop\n\t"
-        "jbmi   0b\n\t"
-        :
-        :
-        : "a0", "memory", "cc"
-        );
+        if (plane < v_planes - 1)
+            blit_wait();        /* the next plane needs the blitter */
     }
 
     /*
-     * invalidate any cached screen data
+     * invalidate any cached screen data (when the blitter has finished)
      */
-    invalidate_data_cache(b->addr, v_lin_wr*ycount);
+    blit_end(b->addr, v_lin_wr*ycount);
 
     return TRUE;
 }
@@ -451,6 +499,26 @@ void OPTIMIZE_SMALL draw_rect_common(const VwkAttrib *attr, const Rect *rect)
     BLITPARM b;
 #endif
 
+#if CONF_WITH_VDI_EXTENSIONS
+    if (cur_region) {
+        region_draw_rect(attr, rect);
+        return;
+    }
+#endif
+
+#if CONF_WITH_VDI_PROFILE
+    vdi_pixels += (ULONG)(rect->x2 - rect->x1 + 1) * (rect->y2 - rect->y1 + 1);
+#endif
+
+    cur_protect(rect->x1, rect->y1, rect->x2, rect->y2);
+
+#if CONF_WITH_VDI_16BIT
+    if (TRUECOLOR_MODE) {
+        tc_draw_rect(attr, rect);
+        return;
+    }
+#endif
+
     leftmask = 0xffff >> (rect->x1 & 0x0f);
     rightmask = 0xffff << (15 - (rect->x2 & 0x0f));
     width = (rect->x2 >> 4) - (rect->x1 >> 4) + 1;
@@ -484,6 +552,8 @@ void OPTIMIZE_SMALL draw_rect_common(const VwkAttrib *attr, const Rect *rect)
     }
 #endif
 
+    blit_sync();                /* we're about to access the screen */
+
     centre = width - 2;
 
     switch(attr->wrt_mode) {
@@ -838,18 +908,18 @@ void vdi_v_pline(Vwk * vwk)
  *  4   y is above
  *  8   y is below
  */
-static WORD clip_code(Vwk * vwk, WORD x, WORD y)
+static WORD clip_code(const VwkClip * clip, WORD x, WORD y)
 {
     WORD clip_flag;
 
     clip_flag = 0;
-    if (x < vwk->xmn_clip)
+    if (x < clip->xmn_clip)
         clip_flag = 1;
-    else if (x > vwk->xmx_clip)
+    else if (x > clip->xmx_clip)
         clip_flag = 2;
-    if (y < vwk->ymn_clip)
+    if (y < clip->ymn_clip)
         clip_flag += 4;
-    else if (y > vwk->ymx_clip)
+    else if (y > clip->ymx_clip)
         clip_flag += 8;
     return (clip_flag);
 }
@@ -861,13 +931,13 @@ static WORD clip_code(Vwk * vwk, WORD x, WORD y)
  * returns FALSE iff the line lies outside the clipping rectangle
  * otherwise, updates the contents of the Line structure & returns TRUE
  */
-BOOL clip_line(Vwk * vwk, Line * line)
+BOOL clip_line(const VwkClip * clip, Line * line)
 {
     WORD deltax, deltay, x1y1_clip_flag, x2y2_clip_flag, line_clip_flag;
     WORD *x, *y;
 
-    while ((x1y1_clip_flag = clip_code(vwk, line->x1, line->y1)) |
-           (x2y2_clip_flag = clip_code(vwk, line->x2, line->y2))) {
+    while ((x1y1_clip_flag = clip_code(clip, line->x1, line->y1)) |
+           (x2y2_clip_flag = clip_code(clip, line->x2, line->y2))) {
         if ((x1y1_clip_flag & x2y2_clip_flag))
             return (FALSE);
         if (x1y1_clip_flag) {
@@ -882,17 +952,17 @@ BOOL clip_line(Vwk * vwk, Line * line)
         deltax = line->x2 - line->x1;
         deltay = line->y2 - line->y1;
         if (line_clip_flag & 1) {               /* left ? */
-            *y = line->y1 + mul_div(deltay, (vwk->xmn_clip - line->x1), deltax);
-            *x = vwk->xmn_clip;
+            *y = line->y1 + mul_div(deltay, (clip->xmn_clip - line->x1), deltax);
+            *x = clip->xmn_clip;
         } else if (line_clip_flag & 2) {        /* right ? */
-            *y = line->y1 + mul_div(deltay, (vwk->xmx_clip - line->x1), deltax);
-            *x = vwk->xmx_clip;
+            *y = line->y1 + mul_div(deltay, (clip->xmx_clip - line->x1), deltax);
+            *x = clip->xmx_clip;
         } else if (line_clip_flag & 4) {        /* top ? */
-            *x = line->x1 + mul_div(deltax, (vwk->ymn_clip - line->y1), deltay);
-            *y = vwk->ymn_clip;
+            *x = line->x1 + mul_div(deltax, (clip->ymn_clip - line->y1), deltay);
+            *y = clip->ymn_clip;
         } else if (line_clip_flag & 8) {        /* bottom ? */
-            *x = line->x1 + mul_div(deltax, (vwk->ymx_clip - line->y1), deltay);
-            *y = vwk->ymx_clip;
+            *x = line->x1 + mul_div(deltax, (clip->ymx_clip - line->y1), deltay);
+            *y = clip->ymx_clip;
         }
     }
     return (TRUE);              /* segment now clipped  */
@@ -917,7 +987,7 @@ void polyline(Vwk * vwk, Point * point, int count, WORD color)
         line.x2 = point->x;
         line.y2 = point->y;
 
-        if (!vwk->clip || clip_line(vwk, &line))
+        if (!vwk->clip || clip_line(VDI_CLIP(vwk), &line))
             abline(&line, vwk->wrt_mode, color);
     }
 }
@@ -1117,30 +1187,81 @@ static void cir_dda(WORD line_width)
  */
 static void do_circ(Vwk * vwk, WORD cx, WORD cy)
 {
-    Line line;
+    VwkAttrib attr;
+    const VwkClip *clipper;
     WORD k;
     WORD *pointer;
 
+    Vwk2Attrib(vwk, &attr, vwk->line_color);
+    clipper = VDI_CLIP(vwk);
+
+    /* Horizontal line through the center of the circle. */
+    draw_span(&attr, clipper, cx - q_circle[0], cx + q_circle[0], cy);
+
     /* Do the upper and lower semi-circles. */
-    for (k = 0, pointer = q_circle; k < num_qc_lines; k++, pointer++) {
-        /* Upper semi-circle, plus the horizontal line through the center of the circle. */
-        line.x1 = cx - *pointer;
-        line.x2 = cx + *pointer;
-        line.y1 = cy - k;
-        line.y2 = cy - k;
-        if (clip_line(vwk, &line))
-            horzline(vwk, &line);
-
-        if (k == 0)
-            continue;
+    for (k = 1, pointer = q_circle+1; k < num_qc_lines; k++, pointer++) {
+        draw_span(&attr, clipper, cx - *pointer, cx + *pointer, cy - k);
+        draw_span(&attr, clipper, cx - *pointer, cx + *pointer, cy + k);
+    }
+}
+
 
-        /* Lower semi-circle. */
-        line.x1 = cx - *pointer;
-        line.x2 = cx + *pointer;
-        line.y1 = cy + k;
-        line.y2 = cy + k;
-        if (clip_line(vwk, &line))
-            horzline(vwk, &line);
+/*
+ * fill_quad - fill the box for one segment of a wideline
+ *
+ * The box is a convex quadrilateral (a parallelogram), so each scan line
+ * crosses it in a single span, running from the leftmost to the rightmost
+ * edge intersection.  The span is drawn directly, which is much cheaper
+ * than the general polygon code (no sorting of intersections, and no
+ * separate perimeter drawing).
+ *
+ * Note: box[] must have room for 5 points.
+ */
+static void fill_quad(Vwk * vwk, Point * box)
+{
+    VwkAttrib attr;
+    const VwkClip *clipper;
+    Point *p;
+    WORD i, y, miny, maxy, x, xl, xr;
+
+    clipper = VDI_CLIP(vwk);
+
+    miny = maxy = box[0].y;
+    for (i = 1, p = box+1; i < 4; i++, p++) {
+        if (p->y < miny)
+            miny = p->y;
+        else if (p->y > maxy)
+            maxy = p->y;
+    }
+    if (miny < clipper->ymn_clip)
+        miny = clipper->ymn_clip;
+    if (maxy > clipper->ymx_clip)
+        maxy = clipper->ymx_clip;
+
+    box[4] = box[0];            /* close the box */
+    Vwk2Attrib(vwk, &attr, vwk->line_color);
+
+    for (y = miny; y <= maxy; y++) {
+        xl = MAX_COORDINATE;
+        xr = -MAX_COORDINATE;
+        for (i = 0, p = box; i < 4; i++, p++) {
+            WORD y1 = p[0].y, y2 = p[1].y;
+
+            if ((y < min(y1, y2)) || (y > max(y1, y2)))
+                continue;
+            if (y1 == y2) {     /* horizontal edge */
+                xl = min(xl, min(p[0].x, p[1].x));
+                xr = max(xr, max(p[0].x, p[1].x));
+                continue;
+            }
+            x = p[0].x + mul_div(y - y1, p[1].x - p[0].x, y2 - y1);
+            if (x < xl)
+                xl = x;
+            if (x > xr)
+                xr = x;
+        }
+        if (xl <= xr)
+            draw_span(&attr, clipper, xl, xr, y);
     }
 }
 
@@ -1237,15 +1358,27 @@ void wideline(Vwk * vwk, Point * point, int count)
             continue;
 
         /* Calculate offsets to fatten the line. */
-        if (vx == 0) {
-            /* line is horizontal - do it the simple way */
-            vx = q_circle[0];
-            vy = 0;
-        }
-        else if (vy == 0) {
-            /* line is vertical - do it the simple way */
-            vx = 0;
-            vy = num_qc_lines - 1;
+        if ((vx == 0) || (vy == 0)) {
+            /*
+             * line is vertical or horizontal - the box is a rectangle,
+             * which we can fill directly
+             */
+            Rect rect;
+
+            rect.x1 = min(wx1, wx2);
+            rect.y1 = min(wy1, wy2);
+            rect.x2 = max(wx1, wx2);
+            rect.y2 = max(wy1, wy2);
+            if (vx == 0) {
+                rect.x1 -= q_circle[0];
+                rect.x2 += q_circle[0];
+            } else {
+                rect.y1 -= num_qc_lines - 1;
+                rect.y2 += num_qc_lines - 1;
+            }
+            if (clipbox(VDI_CLIP(vwk), &rect))
+                draw_rect(vwk, &rect, vwk->line_color);
+            goto next;
         }
         else {
             /* Find the offsets in x and y for a point perpendicular */
@@ -1274,8 +1407,9 @@ void wideline(Vwk * vwk, Point * point, int count)
         ptr->x = wx2 + vx;
         ptr->y = wy2 + vy;
 
-        polygon(vwk, box, 4);
+        fill_quad(vwk, box);
 
+next:
         /*
          * If the terminal point of the line segment is an internal joint,
          * or the end style for the last point is not squared,
@@ -1839,11 +1973,31 @@ void abline(const Line *line, WORD wrt_mode, UWORD color)
     Line ordered;
     UWORD x1,y1,x2,y2;          /* the coordinates */
 
+#if CONF_WITH_VDI_EXTENSIONS
+    if (cur_region) {
+        region_abline(line, wrt_mode, color);
+        return;
+    }
+#endif
+
+    cur_protect(min(line->x1, line->x2), min(line->y1, line->y2),
+                max(line->x1, line->x2), max(line->y1, line->y2));
+
+#if CONF_WITH_VDI_16BIT
+    if (TRUECOLOR_MODE) {
+        tc_draw_line(line, wrt_mode, color);
+        return;
+    }
+#endif
+
 #if CONF_WITH_VDI_VERTLINE
     /*
      * optimize drawing of vertical lines
      */
     if (line->x1 == line->x2) {
+#if CONF_WITH_VDI_PROFILE
+        vdi_pixels += max(line->y1, line->y2) - min(line->y1, line->y2) + 1;
+#endif
 #if CONF_WITH_BLITTER
         if (blitter_is_enabled)
         {
@@ -1853,6 +2007,7 @@ void abline(const Line *line, WORD wrt_mode, UWORD color)
         else
 #endif
         {
+            blit_sync();
             vertical_line(line, wrt_mode, color);
             return;
         }
@@ -1899,10 +2054,14 @@ void abline(const Line *line, WORD wrt_mode, UWORD color)
     /*
      * draw any line
      */
+#if CONF_WITH_VDI_PROFILE
+    vdi_pixels += max(x2 - x1, max(y1, y2) - min(y1, y2)) + 1;
+#endif
     ordered.x1 = x1;
     ordered.y1 = y1;
     ordered.x2 = x2;
     ordered.y2 = y2;
+    blit_sync();
     draw_line(&ordered, wrt_mode, color);
 }
 
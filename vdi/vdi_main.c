@@ -10,11 +10,16 @@
 
 #include "config.h"
 #include "portab.h"
+#include "intmath.h"
 #include "vdi_defs.h"
+#include "string.h"
 #include "kprint.h"
 
 /* forward prototypes */
 void screen(void);
+#if CONF_WITH_VDI_EXTENSIONS
+static void vdi_v_batch(Vwk *vwk);
+#endif
 
 
 WORD flip_y;                    /* True if magnitudes being returned */
@@ -107,6 +112,292 @@ static void(* const jmptb2[])(Vwk *) = {
 #define JMPTB2_ENTRIES  ARRAY_SIZE(jmptb2)
 
 
+/*
+ * call_jmptb - call the function in the jump tables for an opcode
+ */
+static void call_jmptb(WORD opcode, Vwk *vwk)
+{
+    if (opcode >= 1 && opcode < 1+JMPTB1_ENTRIES) {
+        (*jmptb1[opcode - 1]) (vwk);
+    }
+
+    else if (opcode >= 100 && opcode < 100+JMPTB2_ENTRIES) {
+        (*jmptb2[opcode - 100]) (vwk);
+    }
+}
+
+
+#if CONF_WITH_VDI_EXTENSIONS
+/*
+ * call_clipped - call the function for an opcode, clipping to the
+ * workstation's clip region if it has one (see vdi_region.c)
+ */
+#define REPEAT_PTSIN    4       /* max # of PTSIN entries used by repeated functions */
+
+static void call_clipped(WORD opcode, Vwk *vwk)
+{
+    const ClipRegion *region;
+    VwkClip bounds;
+    WORD save_ptsin[2*REPEAT_PTSIN];
+    WORD npts, n;
+
+    if (!vwk || (vwk->region.count == 0)) {
+        call_jmptb(opcode, vwk);
+        return;
+    }
+
+    region = &vwk->region;
+
+    switch(region_mode(opcode, CONTRL[SUBROUTINE])) {
+    case REGION_SPLIT:
+        cur_region = region;
+        call_jmptb(opcode, vwk);
+        cur_region = NULL;
+        break;
+    case REGION_REPEAT:
+        /* the function may modify PTSIN, so we restore it for each call */
+        npts = max(0, min(CONTRL[N_PTSIN], REPEAT_PTSIN));
+        memcpy(save_ptsin, PTSIN, npts * 2 * sizeof(WORD));
+        bounds = *VDI_CLIP(vwk);
+        for (n = 0; n < region->count; n++) {
+            *VDI_CLIP(vwk) = region->rect[n];
+            memcpy(PTSIN, save_ptsin, npts * 2 * sizeof(WORD));
+            call_jmptb(opcode, vwk);
+        }
+        *VDI_CLIP(vwk) = bounds;
+        break;
+    default:
+        call_jmptb(opcode, vwk);
+        break;
+    }
+}
+#else
+#define call_clipped(opcode, vwk)   call_jmptb(opcode, vwk)
+#endif
+
+
+/*
+ * call the function corresponding to the opcode
+ */
+static void call_function(WORD opcode, Vwk *vwk)
+{
+#if CONF_WITH_VDI_EXTENSIONS
+    if (opcode == V_BATCH) {
+        vdi_v_batch(vwk);
+        return;
+    }
+    if (opcode == V_FLUSHBM) {
+        vdi_v_flushbm(vwk);
+        return;
+    }
+    if (opcode == VS_COLORS) {
+        vdi_vs_colors(vwk);
+        return;
+    }
+
+    /* output to an off-screen bitmap workstation goes to the bitmap */
+    if (vwk && vwk->bitmap && !bitmap_uses_screen(opcode)) {
+        bitmap_mark(vwk, opcode);
+        bitmap_select(vwk);
+        call_clipped(opcode, vwk);
+        bitmap_deselect();
+        return;
+    }
+#endif
+
+    call_clipped(opcode, vwk);
+}
+
+
+#if CONF_WITH_BLITTER && CONF_WITH_VDI_ASYNC_BLIT
+/*
+ * may_overlap - return TRUE iff the function for an opcode may start
+ * while a blit is still running (see vdi_line.c)
+ *
+ * these functions either draw only via draw_rect_common() & abline(),
+ * which synchronise as required, or do not access the screen at all.
+ */
+static BOOL may_overlap(WORD opcode)
+{
+    switch(opcode) {
+    case 6:                     /* v_pline() */
+    case 7:                     /* v_pmarker() */
+    case 9:                     /* v_fillarea() */
+    case 114:                   /* vr_recfl() */
+    case 129:                   /* vs_clip() */
+        return TRUE;
+    case 11:                    /* v_gdp(), except v_justified() */
+        return (CONTRL[SUBROUTINE] != 10);
+    }
+
+    /* attribute functions */
+    if ((opcode >= 12) && (opcode <= 25))
+        return TRUE;
+    if ((opcode == 32) || (opcode == 39) || (opcode == 104))
+        return TRUE;
+    if (((opcode >= 106) && (opcode <= 108)) || (opcode == 112) || (opcode == 113))
+        return TRUE;
+
+    return FALSE;
+}
+#endif
+
+
+/*
+ * dispatch - call the function for an opcode, profiling it if required
+ */
+static void dispatch(WORD opcode, Vwk *vwk)
+{
+#if CONF_WITH_BLITTER && CONF_WITH_VDI_ASYNC_BLIT
+    if (!may_overlap(opcode))
+        blit_sync();
+#endif
+
+#if CONF_WITH_VDI_PROFILE
+    if (vdi_profiling()) {
+        ProfileStart start;
+
+        profile_begin(&start);
+        call_function(opcode, vwk);
+        profile_end(opcode, &start);
+        return;
+    }
+#endif
+
+    call_function(opcode, vwk);
+}
+
+
+#if CONF_WITH_VDI_EXTENSIONS
+/*
+ * is_batchable - return TRUE iff the opcode may be used within v_batch()
+ *
+ * this excludes workstation open/close, inquiries, input functions and
+ * vector exchanges, since their results would be discarded anyway.
+ */
+static BOOL is_batchable(WORD opcode)
+{
+    switch(opcode) {
+    case 3:                     /* v_clrwk() */
+    case 6:                     /* v_pline() */
+    case 7:                     /* v_pmarker() */
+    case 8:                     /* v_gtext() */
+    case 9:                     /* v_fillarea() */
+    case 11:                    /* v_gdp() */
+    case 103:                   /* v_contourfill() */
+    case 109:                   /* vro_cpyfm() */
+    case 110:                   /* vr_trnfm() */
+    case 114:                   /* vr_recfl() */
+    case 121:                   /* vrt_cpyfm() */
+    case 122:                   /* v_show_c() */
+    case 123:                   /* v_hide_c() */
+    case 129:                   /* vs_clip() */
+        return TRUE;
+    }
+
+    /* attribute functions */
+    if ((opcode >= 12) && (opcode <= 25))
+        return TRUE;
+    if ((opcode == 32) || (opcode == 39) || (opcode == 104))
+        return TRUE;
+    if ((opcode >= 106) && (opcode <= 113) && (opcode != 108))
+        return TRUE;
+
+    return FALSE;
+}
+
+
+/*
+ * vdi_v_batch - execute a buffer of VDI commands in a single call
+ *
+ * This is an EmuTOS extension.  A pointer to the command buffer is
+ * passed in CONTRL[7-8].  The buffer consists of a sequence of commands,
+ * each of which has the following format (all values are WORDs):
+ *
+ *  [0]     total length of the command in WORDs, including this header;
+ *          a length of zero terminates the buffer
+ *  [1]     opcode (as CONTRL[0])
+ *  [2]     number of PTSIN vertices (as CONTRL[1])
+ *  [3]     number of INTIN values (as CONTRL[3])
+ *  [4]     subfunction (as CONTRL[5])
+ *  [5-8]   values for CONTRL[7-10], e.g. MFDB pointers for raster functions
+ *  [9-]    PTSIN values, followed by INTIN values
+ *
+ * Any data following the INTIN values (e.g. MFDBs referenced by [5-8])
+ * is skipped.  All commands apply to the workstation specified by the
+ * handle of the v_batch() call, so the workstation lookup is done once
+ * for the whole buffer.  Values returned by individual commands are
+ * discarded.  Execution stops at the first command whose opcode is not
+ * allowed (see is_batchable() above).
+ *
+ * On return, INTOUT[0] contains the number of commands executed.
+ */
+#define BATCH_HDR_LEN   9
+
+static WORD batch_contrl[11];
+static WORD batch_intout[12];
+static WORD batch_ptsout[12];
+
+static void vdi_v_batch(Vwk *vwk)
+{
+    WORD *cmd, *save_contrl, *save_intout, *save_ptsout, *save_intin;
+    WORD len, opcode, npts, count;
+
+    cmd = *(WORD **)&CONTRL[7];
+
+    save_contrl = CONTRL;
+    save_intin = INTIN;
+    save_intout = INTOUT;
+    save_ptsout = PTSOUT;
+    CONTRL = batch_contrl;
+    INTOUT = batch_intout;
+    PTSOUT = batch_ptsout;
+    CONTRL[VDI_HANDLE] = vwk->handle;
+
+    for (count = 0; (len = cmd[0]) >= BATCH_HDR_LEN; cmd += len, count++) {
+        opcode = cmd[1];
+        if (!is_batchable(opcode))
+            break;
+
+        /*
+         * the PTSIN values are copied to the local PTSIN array set up
+         * by the trap handler, so that functions which modify PTSIN in
+         * place do not damage the caller's buffer, which may be reused
+         */
+        npts = cmd[2];
+        if (npts < 0)
+            npts = 0;
+        INTIN = cmd + BATCH_HDR_LEN + 2 * npts;
+        if (npts > MAX_PTSIN)
+            npts = MAX_PTSIN;
+        memcpy(PTSIN, cmd+BATCH_HDR_LEN, npts * 2 * sizeof(WORD));
+
+        CONTRL[ROUTINE] = opcode;
+        CONTRL[N_PTSIN] = npts;
+        CONTRL[N_PTSOUT] = 0;
+        CONTRL[N_INTIN] = cmd[3];
+        CONTRL[N_INTOUT] = 0;
+        CONTRL[SUBROUTINE] = cmd[4];
+        memcpy(&CONTRL[7], cmd+5, 4 * sizeof(WORD));
+
+        if (vwk->fill_style != 4)       /* multifill just for user */
+            vwk->multifill = 0;
+
+        dispatch(opcode, vwk);
+    }
+
+    CONTRL = save_contrl;
+    INTIN = save_intin;
+    INTOUT = save_intout;
+    PTSOUT = save_ptsout;
+
+    flip_y = 0;
+    CONTRL[N_INTOUT] = 1;
+    INTOUT[0] = count;
+}
+#endif
+
+
 /*
  * screen - Screen driver entry point
  */
@@ -137,11 +428,12 @@ void screen(void)
             vwk->multifill = 0;
     }
 
-    if (opcode >= 1 && opcode < 1+JMPTB1_ENTRIES) {
-        (*jmptb1[opcode - 1]) (vwk);
-    }
-
-    else if (opcode >= 100 && opcode < 100+JMPTB2_ENTRIES) {
-        (*jmptb2[opcode - 100]) (vwk);
-    }
+#if CONF_WITH_BLITTER && CONF_WITH_VDI_ASYNC_BLIT
+    blit_async = TRUE;
+    dispatch(opcode, vwk);
+    blit_async = FALSE;
+    blit_sync();                /* the caller may access the screen */
+#else
+    dispatch(opcode, vwk);
+#endif
 }
@@ -179,6 +179,11 @@ UWORD * get_start_addr(const WORD x, const WORD y)
 
     /* init address counter */
     addr = v_bas_ad;                    /* start of screen */
+#if CONF_WITH_VDI_16BIT
+    if (TRUECOLOR_MODE)                 /* one word per pixel */
+        addr += x * sizeof(UWORD);
+    else
+#endif
     addr += (x&0xfff0)>>shift_offset[v_planes]; /* add x coordinate part of addr */
     addr += muls(y, v_lin_wr);          /* add y coordinate part of addr */
 
@@ -47,6 +47,7 @@ extern void call_user_wheel(WORD wheel_number, WORD wheel_amount);
 /* prototypes */
 static void cur_display(Mcdb *sprite, MCS *savebuf, WORD x, WORD y);
 static void cur_replace(MCS *savebuf);
+static void show_mouse(WORD x, WORD y);
 static void vb_draw(void);             /* user button vector */
 
 /* prototypes for functions in vdi_asm.S */
@@ -59,6 +60,26 @@ extern void mov_cur(void);      /* user button vector */
 void     (*user_wheel)(void);   /* user provided mouse wheel vector */
 PFVOID old_statvec;             /* original IKBD status packet routine */
 
+/*
+ * deferred hiding of the mouse cursor
+ *
+ * v_hide_c() normally removes the cursor from the screen immediately.
+ * As an EmuTOS extension, if INTIN[0] is HIDE_DEFERRED, the cursor is
+ * left where it is (frozen, since it is formally hidden) until a VDI
+ * drawing function is about to access the screen area that it occupies:
+ * see cur_protect().  If it is still on the screen when it is shown
+ * again, and the mouse hasn't moved, it doesn't need to be redrawn.
+ *
+ * This is used by the AES around its own drawing, which is often nowhere
+ * near the mouse.  It must not be used if the screen may be written
+ * directly, rather than via the VDI.
+ */
+#define HIDE_DEFERRED   1
+
+static BOOL cur_deferred;       /* TRUE iff hidden, but still on screen */
+static UBYTE *cur_base;         /* screen address when cursor was drawn */
+static WORD cur_x, cur_y;       /* position of cursor (hot spot) when drawn */
+
 
 #if !WITH_AES
 /* Default Mouse Cursor Definition */
@@ -130,10 +151,20 @@ static void do_nothing(void)
  */
 static void dis_cur(void)
 {
+    BOOL on_screen = FALSE;
+
     mouse_flag += 1;            /* disable mouse redrawing */
     HIDE_CNT -= 1;              /* decrement hide operations counter */
     if (HIDE_CNT == 0) {
-        cur_display(&mouse_cdb, mcs_ptr, GCURX, GCURY);  /* display the cursor */
+        if (cur_deferred) {     /* cursor is still on screen */
+            cur_deferred = FALSE;
+            if ((GCURX == cur_x) && (GCURY == cur_y))
+                on_screen = TRUE;
+            else
+                cur_replace(mcs_ptr);
+        }
+        if (!on_screen)
+            show_mouse(GCURX, GCURY);   /* display the cursor */
         draw_flag = 0;          /* disable vbl drawing routine */
     }
     else if (HIDE_CNT < 0) {
@@ -170,9 +201,71 @@ static void hide_cur(void)
         cur_replace(mcs_ptr);   /* remove the cursor from screen */
         draw_flag = 0;          /* disable vbl drawing routine */
     }
+    else if (cur_deferred) {    /* hidden, but still on screen */
+        cur_replace(mcs_ptr);
+        cur_deferred = FALSE;
+    }
+
+    mouse_flag -= 1;            /* re-enable mouse drawing */
+}
+
+
+
+#if CONF_WITH_VDI_EXTENSIONS
+/*
+ * hide_cur_deferred - like hide_cur(), but leave the cursor on screen
+ */
+static void hide_cur_deferred(void)
+{
+    mouse_flag += 1;            /* disable mouse redrawing */
+
+    HIDE_CNT += 1;
+    if ((HIDE_CNT == 1) && (mcs_ptr->stat & MCS_VALID)) {
+        cur_deferred = TRUE;
+        draw_flag = 0;          /* disable vbl drawing routine */
+    }
 
     mouse_flag -= 1;            /* re-enable mouse drawing */
 }
+#endif
+
+
+
+/*
+ * cur_protect - called before the VDI accesses an area of the screen
+ *
+ * if the cursor has been hidden via hide_cur_deferred(), but is still on
+ * the screen, and overlaps the area, it is removed now.
+ */
+void cur_protect(WORD x1, WORD y1, WORD x2, WORD y2)
+{
+    WORD cx, cy;
+
+    if (!cur_deferred || (v_bas_ad != cur_base))
+        return;
+
+    cx = cur_x - mouse_cdb.xhot;
+    cy = cur_y - mouse_cdb.yhot;
+    if ((x2 < cx) || (x1 > cx+15) || (y2 < cy) || (y1 > cy+15))
+        return;
+
+    blit_sync();
+    cur_replace(mcs_ptr);
+    cur_deferred = FALSE;
+}
+
+
+
+/*
+ * show_mouse - display the mouse cursor & remember where it is
+ */
+static void show_mouse(WORD x, WORD y)
+{
+    cur_display(&mouse_cdb, mcs_ptr, x, y);
+    cur_base = v_bas_ad;
+    cur_x = x;
+    cur_y = y;
+}
 
 
 
@@ -333,9 +426,18 @@ void vdi_v_show_c(Vwk * vwk)
 
 /*
  * vdi_v_hide_c - hide cursor
+ *
+ * see the description of HIDE_DEFERRED above for the EmuTOS extension
  */
 void vdi_v_hide_c(Vwk * vwk)
 {
+#if CONF_WITH_VDI_EXTENSIONS
+    if ((CONTRL[N_INTIN] > 0) && (INTIN[0] == HIDE_DEFERRED)) {
+        hide_cur_deferred();
+        return;
+    }
+#endif
+
     linea_hide_mouse();
 }
 
@@ -606,6 +708,8 @@ void vdimouse_init(void)
 
     /* mouse settings */
     HIDE_CNT = 1;               /* mouse is initially hidden */
+    cur_deferred = FALSE;
+    mcs_ptr->stat = 0;          /* nothing saved */
     GCURX = xres / 2;           /* initialize the mouse to center */
     GCURY = yres / 2;
 
@@ -690,9 +794,16 @@ static void vb_draw(void)
     if (draw_flag) {
         draw_flag = FALSE;
         set_sr(old_sr);
-        if (!mouse_flag) {
+        /*
+         * the cursor is redrawn at most once per VBL, however many
+         * movements have been reported since the last one.  since
+         * movements are reported even when the cursor is held at the
+         * edge of the screen, check that it really has moved.
+         */
+        if (!mouse_flag
+         && ((newx != cur_x) || (newy != cur_y) || !(mcs_ptr->stat & MCS_VALID))) {
             cur_replace(mcs_ptr);       /* remove the old cursor from the screen */
-            cur_display(&mouse_cdb, mcs_ptr, newx, newy);  /* display the cursor */
+            show_mouse(newx, newy);     /* display the cursor */
         }
     } else
         set_sr(old_sr);
@@ -786,6 +897,70 @@ static void cur_display_clip(WORD op,Mcdb *sprite,MCS *mcs,UWORD *mask_start,UWO
     } /* loop through planes */
 }
 
+#if CONF_WITH_VDI_16BIT
+/*
+ * cur_display_16() - cur_display() for 16-bit video modes
+ *
+ * the save area holds one word per pixel: since the cursor is at most
+ * 16x16 pixels, this fits in the (extended) save area.  clipping is
+ * handled by saving & drawing only the visible part of each row.
+ */
+static void cur_display_16(Mcdb *sprite, MCS *mcs, WORD x, WORD y)
+{
+    WORD x1, y1, x2, y2, row, col, shft;
+    UWORD *src, *dst, *save;
+    UWORD fg, bg, fgbits, bgbits;
+    const WORD dst_inc = v_lin_wr >> 1;
+
+    x1 = (x < 0) ? 0 : x;
+    y1 = (y < 0) ? 0 : y;
+    x2 = (x+15 > xres) ? xres : x+15;
+    y2 = (y+15 > yres) ? yres : y+15;
+    if ((x1 > x2) || (y1 > y2))
+        return;                 /* entirely off screen */
+
+    src = sprite->maskdata + ((y1 - y) << 1);
+    shft = x1 - x;              /* # invisible pixels at left */
+    fg = tc_palette[sprite->fg_col & 0xff];
+    bg = tc_palette[sprite->bg_col & 0xff];
+
+    dst = get_start_addr(x1, y1);
+    mcs->len = y2 - y1 + 1;
+    mcs->width = x2 - x1 + 1;
+    mcs->addr = dst;
+    mcs->stat = MCS_VALID;
+    save = (UWORD *)mcs->area;
+
+    for (row = mcs->len; row > 0; row--, dst += dst_inc) {
+        bgbits = *src++ << shft;
+        fgbits = *src++ << shft;
+        for (col = 0; col < mcs->width; col++, bgbits <<= 1, fgbits <<= 1) {
+            *save++ = dst[col];
+            if (fgbits & 0x8000)
+                dst[col] = fg;
+            else if (bgbits & 0x8000)
+                dst[col] = bg;
+        }
+    }
+}
+
+/*
+ * cur_replace_16() - cur_replace() for 16-bit video modes
+ */
+static void cur_replace_16(MCS *mcs)
+{
+    UWORD *src, *dst;
+    WORD row, col;
+    const WORD dst_inc = v_lin_wr >> 1;
+
+    src = (UWORD *)mcs->area;
+    dst = mcs->addr;
+    for (row = mcs->len; row > 0; row--, dst += dst_inc)
+        for (col = 0; col < mcs->width; col++)
+            dst[col] = *src++;
+}
+#endif
+
 /*
  * cur_display() - blits a "cursor" to the destination
  *
@@ -815,6 +990,13 @@ static void cur_display (Mcdb *sprite, MCS *mcs, WORD x, WORD y)
 
     mcs->stat = 0x00;           /* reset status of save buffer */
 
+#if CONF_WITH_VDI_16BIT
+    if (TRUECOLOR_MODE) {
+        cur_display_16(sprite, mcs, x, y);
+        return;
+    }
+#endif
+
     /*
      * clip x axis
      */
@@ -962,6 +1144,13 @@ static void cur_replace (MCS *mcs)
         return;
     mcs->stat &= ~MCS_VALID;        /* yes but (like TOS) don't allow reuse */
 
+#if CONF_WITH_VDI_16BIT
+    if (TRUECOLOR_MODE) {
+        cur_replace_16(mcs);
+        return;
+    }
+#endif
+
     addr = mcs->addr;
     src = (UWORD *)mcs->area;
 
@@ -1030,5 +1219,9 @@ void linea_hide_mouse(void)
 
 void linea_transform_mouse(void)
 {
+    if (cur_deferred) {         /* remove the old shape from the screen */
+        cur_replace(mcs_ptr);
+        cur_deferred = FALSE;
+    }
     set_mouse_form((const MFORM *)INTIN, &mouse_cdb);
 }
@@ -0,0 +1,187 @@
+/*
+ * vdi_profile.c - VDI performance counters
+ *
+ * Copyright 2018 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#include "config.h"
+#include "portab.h"
+#include "string.h"
+#include "vdi_defs.h"
+#include "../bios/tosvars.h"
+#include "../bios/mfp.h"
+
+#if CONF_WITH_VDI_PROFILE
+
+/*
+ * When profiling is enabled, the VDI dispatcher counts, for each opcode,
+ * the number of calls, the number of pixels written, and the elapsed
+ * time.  Profiling is controlled by a VDI escape (see vdi_v_profile()
+ * below), which can also copy the counters to a buffer supplied by the
+ * caller.
+ *
+ * The pixel count is maintained by the low-level drawing code (rectangle
+ * fills, lines, raster copies & text output), so it is the number of
+ * pixels actually written, after clipping.  Since v_batch() calls the
+ * dispatcher for each function in the buffer, its figures include those
+ * of the functions that it executes.
+ *
+ * Time is measured in units of 1/38400 second (about 26 microseconds):
+ * this is the rate at which MFP timer C, the 200Hz system timer, counts
+ * down.  Without an MFP, the time is still reported in the same units,
+ * but only has a resolution of 5 milliseconds.
+ */
+
+#define TIMERC_COUNT    192     /* timer C counts per 200Hz tick */
+
+/* opcodes are mapped to table entries as follows */
+#define NUM_OPCODES1    39      /* 1-39 */
+#define NUM_OPCODES2    35      /* 100-134 */
+#define NUM_OPCODES3    3       /* 250-252 (EmuTOS extensions) */
+#define NUM_PROFILE_ENTRIES (NUM_OPCODES1+NUM_OPCODES2+NUM_OPCODES3)
+
+ULONG vdi_pixels;               /* updated by the drawing code */
+
+static BOOL profiling;
+static VdiProfile profile[NUM_PROFILE_ENTRIES];
+
+
+/*
+ * profile_time - return the current time in units of 1/38400 second
+ */
+static ULONG profile_time(void)
+{
+#if CONF_WITH_MFP && !CONF_COLDFIRE_TIMER_C
+    ULONG ticks;
+    UBYTE count;
+
+    /* make sure that the tick count & the timer count are consistent */
+    do {
+        ticks = hz_200;
+        count = MFP_BASE->tcdr;
+    } while (ticks != hz_200);
+
+    return ticks * TIMERC_COUNT + (TIMERC_COUNT - count);
+#else
+    return hz_200 * TIMERC_COUNT;
+#endif
+}
+
+
+/*
+ * profile_entry - return the table entry for an opcode, or NULL
+ */
+static VdiProfile *profile_entry(WORD opcode)
+{
+    if ((opcode >= 1) && (opcode < 1+NUM_OPCODES1))
+        return &profile[opcode-1];
+    if ((opcode >= 100) && (opcode < 100+NUM_OPCODES2))
+        return &profile[NUM_OPCODES1+opcode-100];
+    if ((opcode >= 250) && (opcode < 250+NUM_OPCODES3))
+        return &profile[NUM_OPCODES1+NUM_OPCODES2+opcode-250];
+
+    return NULL;
+}
+
+
+/*
+ * profile_reset - clear all counters
+ */
+static void profile_reset(void)
+{
+    WORD i;
+    VdiProfile *p;
+
+    memset(profile, 0, sizeof(profile));
+    for (i = 1; i < 250+NUM_OPCODES3; i++) {
+        p = profile_entry(i);
+        if (p)
+            p->opcode = i;
+    }
+}
+
+
+/*
+ * vdi_profiling - return TRUE iff profiling is enabled
+ */
+BOOL vdi_profiling(void)
+{
+    return profiling;
+}
+
+
+/*
+ * profile_begin/profile_end - called by the dispatcher around each function
+ *
+ * profile_begin() saves the starting pixel count & time, which are then
+ * passed to profile_end().
+ */
+void profile_begin(ProfileStart *start)
+{
+    start->pixels = vdi_pixels;
+    start->time = profile_time();
+}
+
+void profile_end(WORD opcode, const ProfileStart *start)
+{
+    VdiProfile *p = profile_entry(opcode);
+
+    if (!p)
+        return;
+
+    p->calls++;
+    p->pixels += vdi_pixels - start->pixels;
+    p->time += profile_time() - start->time;
+}
+
+
+/*
+ * vdi_v_profile - control VDI profiling
+ *
+ * This is an EmuTOS extension: escape ESC_PROFILE (v_escape() subfunction
+ * 2000).  INTIN[0] specifies the action:
+ *  0   disable profiling
+ *  1   enable profiling
+ *  2   reset the counters
+ *  3   copy the counters to the buffer pointed to by INTIN[1-2]; the
+ *      buffer must have room for INTOUT[1] VdiProfile entries.  This is
+ *      ignored if the caller passes fewer than 3 INTIN words.
+ *
+ * On return, INTOUT[0] is 1 if profiling was enabled (before the call),
+ * 0 otherwise; INTOUT[1] is the number of table entries.
+ */
+void vdi_v_profile(Vwk * vwk)
+{
+    INTOUT[0] = profiling;
+    INTOUT[1] = NUM_PROFILE_ENTRIES;
+    CONTRL[N_INTOUT] = 2;
+
+    if (CONTRL[N_INTIN] < 1)
+        return;
+
+    switch(INTIN[0]) {
+    case 0:
+        profiling = FALSE;
+        break;
+    case 1:
+        if (!profile[0].opcode)     /* first time */
+            profile_reset();
+        profiling = TRUE;
+        break;
+    case 2:
+        profile_reset();
+        break;
+    case 3:
+        if (CONTRL[N_INTIN] < 3)
+            break;              /* no buffer address */
+        if (!profile[0].opcode)
+            profile_reset();
+        memcpy(*(VdiProfile **)&INTIN[1], profile, sizeof(profile));
+        break;
+    }
+}
+
+#endif /* CONF_WITH_VDI_PROFILE */
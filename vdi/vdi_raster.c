@@ -12,6 +12,7 @@
 
 #include "config.h"
 #include "portab.h"
+#include "intmath.h"
 #include "vdi_defs.h"
 #include "blitter.h"
 #include "../bios/lineavars.h"
@@ -171,20 +172,6 @@ struct blit_frame {
     WORD src_wr;        /* +74 source form wrap (in bytes) */
 };
 
-/* Raster definitions */
-typedef struct {
-    void *fd_addr;
-    WORD fd_w;
-    WORD fd_h;
-    WORD fd_wdwidth;
-    WORD fd_stand;
-    WORD fd_nplanes;
-    WORD fd_r1;
-    WORD fd_r2;
-    WORD fd_r3;
-} MFDB;
-
-
 extern void linea_blit(struct blit_frame *info); /* called only from linea.S */
 extern void linea_raster(void); /* called only from linea.S */
 #if ASM_BLIT_IS_AVAILABLE
@@ -298,6 +285,7 @@ blitter_do_blit(blit *blt)
      * routines ignore it & act on the whole cache anyway.
      */
     length = (blt->y_cnt * blt->dst_y_inc) + (blt->x_cnt * blt->dst_x_inc);
+    blit_sync();
     flush_data_cache((void *)blt->dst_addr,length);
 
     BLITTER->src_x_incr = blt->src_x_inc;
@@ -315,27 +303,13 @@ blitter_do_blit(blit *blt)
     BLITTER->hop = blt->hop;
     BLITTER->skew = blt->skew;
 
-    /*
-     * we run the blitter in the Atari-recommended way: use no-HOG mode,
-     * and manually restart the blitter until it's done.
-     */
     BLITTER->status = BUSY;     /* no-HOG mode */
-    __asm__ __volatile__(
-    "lea    0xFFFF8A3C,a0\n\t"
-    "0:\n\t"
-    "tas    (a0)\n\t"
-    "nop\n\t"
-    "jbmi   0b\n\t"
-    :
-    :
-    : "a0", "memory", "cc"
-    );
 
     /*
      * we've modified data behind the cpu's back, so we must
-     * invalidate any cached data.
+     * invalidate any cached data (when the blitter has finished).
      */
-    invalidate_data_cache((void *)blt->dst_addr,length);
+    blit_end((void *)blt->dst_addr,length);
 }
 #endif
 
@@ -902,13 +876,136 @@ setup_info (struct raster_t *raster, struct blit_frame * info)
     else
         dont_clip(info);
 
+    /* make sure the mouse cursor isn't included in what we read or write */
+    if (!src->fd_addr)
+        cur_protect(info->s_xmin, info->s_ymin,
+                    info->s_xmin + info->b_wd - 1, info->s_ymin + info->b_ht - 1);
+    if (!dst->fd_addr)
+        cur_protect(info->d_xmin, info->d_ymin,
+                    info->d_xmin + info->b_wd - 1, info->d_ymin + info->b_ht - 1);
+
     info->s_nxpl = 2;           /* next plane offset (source) */
     info->d_nxpl = 2;           /* next plane offset (destination) */
 
+#if CONF_WITH_VDI_16BIT
+    if (TRUECOLOR_MODE && (info->plane_ct == 16))
+        return FALSE;           /* handled by cpy_raster_16() */
+#endif
+
     /* only 8, 4, 2 and 1 planes are valid (destination) */
     return info->plane_ct & ~0x000f;
 }
 
+#if CONF_WITH_VDI_16BIT
+/*
+ * logic_op - apply a vro_cpyfm() logic operation to a source & destination
+ */
+static UWORD logic_op(WORD mode, UWORD s, UWORD d)
+{
+    switch(mode) {
+    case 0:     return 0;
+    case 1:     return s & d;
+    case 2:     return s & ~d;
+    case 3:     return s;
+    case 4:     return ~s & d;
+    case 5:     return d;
+    case 6:     return s ^ d;
+    case 7:     return s | d;
+    case 8:     return ~(s | d);
+    case 9:     return ~(s ^ d);
+    case 10:    return ~d;
+    case 11:    return s | ~d;
+    case 12:    return ~s;
+    case 13:    return ~s | d;
+    case 14:    return ~(s & d);
+    default:    return 0xffff;
+    }
+}
+
+/*
+ * cpy_raster_16 - copy raster to a 16-bit (pixel-packed) form
+ *
+ * for an opaque copy, the source is also a 16-bit form, and the logic
+ * operation is applied to each pixel.  for a transparent copy, the
+ * source is monochrome, and each bit is expanded to the foreground or
+ * background colour according to the writing mode.  patterns are not
+ * supported.
+ */
+static void cpy_raster_16(const struct blit_frame *info, WORD mode, BOOL transparent)
+{
+    UWORD *src, *dst, *s, *d;
+    WORD row, col, dir;
+    WORD s_inc = info->s_nxln / 2;  /* in words */
+    WORD d_inc = info->d_nxln / 2;
+
+    dst = info->d_form + muls(info->d_ymin, d_inc) + info->d_xmin;
+
+    if (transparent) {
+        UWORD fg, bg, bits, bit;
+
+        fg = tc_palette[MAP_COL[validate_color_index(INTIN[1])] & 0xff];
+        bg = tc_palette[MAP_COL[validate_color_index(INTIN[2])] & 0xff];
+        src = info->s_form + muls(info->s_ymin, s_inc) + (info->s_xmin >> 4);
+
+        for (row = info->b_ht; row > 0; row--, src += s_inc, dst += d_inc) {
+            s = src;
+            d = dst;
+            bits = *s++;
+            bit = 0x8000 >> (info->s_xmin & 0x0f);
+            for (col = info->b_wd; col > 0; col--, d++) {
+                switch(mode) {
+                case MD_TRANS:
+                    if (bits & bit)
+                        *d = fg;
+                    break;
+                case MD_XOR:
+                    if (bits & bit)
+                        *d = ~*d;
+                    break;
+                case MD_ERASE:
+                    if (!(bits & bit))
+                        *d = bg;
+                    break;
+                default:        /* MD_REPLACE */
+                    *d = (bits & bit) ? fg : bg;
+                    break;
+                }
+                bit >>= 1;
+                if (!bit) {
+                    bits = *s++;
+                    bit = 0x8000;
+                }
+            }
+        }
+        return;
+    }
+
+    src = info->s_form + muls(info->s_ymin, s_inc) + info->s_xmin;
+
+    /* work backwards if the areas may overlap destructively */
+    dir = 1;
+    if (dst > src) {
+        src += muls(info->b_ht - 1, s_inc) + info->b_wd - 1;
+        dst += muls(info->b_ht - 1, d_inc) + info->b_wd - 1;
+        s_inc = -s_inc;
+        d_inc = -d_inc;
+        dir = -1;
+    }
+
+    for (row = info->b_ht; row > 0; row--, src += s_inc, dst += d_inc) {
+        s = src;
+        d = dst;
+        if (mode == 3) {        /* S_ONLY, by far the most common */
+            for (col = info->b_wd; col > 0; col--, s += dir, d += dir)
+                *d = *s;
+        } else {
+            for (col = info->b_wd; col > 0; col--, s += dir, d += dir)
+                *d = logic_op(mode, *s, *d);
+        }
+    }
+}
+#endif
+
 /* common functionality for vdi_vro_cpyfm, vdi_vrt_cpyfm, linea_raster */
 static void
 cpy_raster(struct raster_t *raster, struct blit_frame *info)
@@ -1013,6 +1110,17 @@ cpy_raster(struct raster_t *raster, struct blit_frame *info)
      */
     blit_info = info;
 
+#if CONF_WITH_VDI_PROFILE
+    vdi_pixels += (ULONG)info->b_wd * info->b_ht;
+#endif
+
+#if CONF_WITH_VDI_16BIT
+    if (info->plane_ct == 16) {
+        cpy_raster_16(info, mode, raster->transparent);
+        return;
+    }
+#endif
+
 #if ASM_BLIT_IS_AVAILABLE
 #if CONF_WITH_BLITTER
     if (blitter_is_enabled)
@@ -0,0 +1,220 @@
+/*
+ * vdi_region.c - clipping to a list of rectangles
+ *
+ * Copyright 2018 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#include "config.h"
+#include "portab.h"
+#include "intmath.h"
+#include "vdi_defs.h"
+#include "../bios/lineavars.h"
+
+#if CONF_WITH_VDI_EXTENSIONS
+
+/*
+ * Normally a workstation clips to a single rectangle.  As an EmuTOS
+ * extension, vs_clip() may instead be passed a list of rectangles (see
+ * vdi_vs_clip()), which then form the clip region.  This allows the AES
+ * to draw an object tree once for all the visible parts of a window,
+ * rather than once for each visible rectangle.
+ *
+ * While a region is in use, the workstation clip rectangle is set to the
+ * bounding box of the region, so the high-level code clips to that as
+ * usual.  How the region itself is applied depends on the function (see
+ * region_mode() below):
+ *  . functions whose output consists entirely of rectangles/spans and
+ *    lines are executed once, with cur_region pointing to the region:
+ *    draw_rect_common() and abline() then split their output against
+ *    the rectangles of the region (region_draw_rect()/region_abline()).
+ *    This means that polygon edges, arcs, wide lines etc are calculated
+ *    only once.
+ *  . v_contourfill() is also executed once: the seed point must be within
+ *    the region, and the spans are split as above.  Note that the extent
+ *    of the fill is determined by all the pixels within the bounding box,
+ *    so it may pass through parts of the screen outside the region.
+ *  . other functions that clip their output (text, raster copies) are
+ *    called once per rectangle by the dispatcher, with the workstation
+ *    clip rectangle set to that rectangle.
+ *
+ * The rectangles are sorted by their upper edge, so that splitting can
+ * stop as soon as it reaches a rectangle below the output.  They should
+ * not overlap, otherwise the overlapping parts are drawn more than once,
+ * which matters for XOR mode.  Likewise, a screen-to-screen raster copy
+ * whose source & destination overlap will not give the expected result
+ * when it is clipped to a region.
+ */
+
+const ClipRegion *cur_region;   /* region for the current function, or NULL */
+
+
+/*
+ * region_set - set the clip region of a workstation
+ *
+ * the rectangles are clipped to the screen, and empty ones are ignored.
+ * the workstation clip rectangle is set to the bounding box of the
+ * rectangles that remain.  if there is only one, it is used as a normal
+ * clip rectangle.
+ *
+ * returns the number of rectangles used: if this is zero, the clip
+ * rectangle has not been changed.
+ */
+WORD region_set(Vwk *vwk, Rect *rect, WORD count)
+{
+    ClipRegion *region = &vwk->region;
+    VwkClip *r, *bounds = VDI_CLIP(vwk);
+    VwkClip clip;
+    WORD n;
+
+    region->count = 0;
+    if (count > MAX_CLIP_RECTS)
+        count = MAX_CLIP_RECTS;
+
+    for (n = 0; n < count; n++, rect++) {
+        arb_corner(rect);
+        clip.xmn_clip = max(0, rect->x1);
+        clip.ymn_clip = max(0, rect->y1);
+        clip.xmx_clip = min(xres, rect->x2);
+        clip.ymx_clip = min(yres, rect->y2);
+        if ((clip.xmn_clip > clip.xmx_clip) || (clip.ymn_clip > clip.ymx_clip))
+            continue;
+
+        /* insert in order of upper edge, then left edge */
+        for (r = region->rect + region->count; r > region->rect; r--) {
+            if (r[-1].ymn_clip < clip.ymn_clip)
+                break;
+            if ((r[-1].ymn_clip == clip.ymn_clip) && (r[-1].xmn_clip <= clip.xmn_clip))
+                break;
+            *r = r[-1];
+        }
+        *r = clip;
+        region->count++;
+    }
+
+    count = region->count;
+    if (count == 0)
+        return 0;
+
+    *bounds = region->rect[0];
+    for (n = 1, r = region->rect + 1; n < count; n++, r++) {
+        bounds->xmn_clip = min(bounds->xmn_clip, r->xmn_clip);
+        bounds->xmx_clip = max(bounds->xmx_clip, r->xmx_clip);
+        bounds->ymx_clip = max(bounds->ymx_clip, r->ymx_clip);
+    }
+
+    if (count == 1)
+        region->count = 0;      /* the bounding box is all we need */
+
+    return count;
+}
+
+
+/*
+ * region_mode - return how the clip region applies to a function
+ */
+WORD region_mode(WORD opcode, WORD subfunction)
+{
+    switch(opcode) {
+    case 6:                     /* v_pline() */
+    case 7:                     /* v_pmarker() */
+    case 9:                     /* v_fillarea() */
+    case 103:                   /* v_contourfill() */
+    case 114:                   /* vr_recfl() */
+        return REGION_SPLIT;
+    case 11:                    /* v_gdp() */
+        if (subfunction == 10)  /* v_justified() */
+            return REGION_REPEAT;
+        return REGION_SPLIT;
+    case 8:                     /* v_gtext() */
+    case 109:                   /* vro_cpyfm() */
+    case 121:                   /* vrt_cpyfm() */
+        return REGION_REPEAT;
+    }
+
+    return REGION_ONCE;
+}
+
+
+/*
+ * region_contains - return TRUE iff the point (x,y) is within cur_region
+ */
+BOOL region_contains(WORD x, WORD y)
+{
+    const VwkClip *clip;
+    WORD n;
+
+    for (n = cur_region->count, clip = cur_region->rect; n > 0; n--, clip++) {
+        if (clip->ymn_clip > y)
+            break;              /* this & all following ones are below */
+        if ((y <= clip->ymx_clip) && (x >= clip->xmn_clip) && (x <= clip->xmx_clip))
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+
+/*
+ * region_draw_rect - draw the parts of a rectangle within cur_region
+ *
+ * called by draw_rect_common() when cur_region is set
+ */
+void region_draw_rect(const VwkAttrib *attr, const Rect *rect)
+{
+    const ClipRegion *region = cur_region;
+    const VwkClip *clip;
+    Rect part;
+    WORD n;
+
+    cur_region = NULL;          /* so that draw_rect_common() draws */
+
+    for (n = region->count, clip = region->rect; n > 0; n--, clip++) {
+        if (clip->ymn_clip > rect->y2)
+            break;              /* this & all following ones are below */
+        part = *rect;
+        if (clipbox(clip, &part))
+            draw_rect_common(attr, &part);
+    }
+
+    cur_region = region;
+}
+
+
+/*
+ * region_abline - draw the parts of a line within cur_region
+ *
+ * called by abline() when cur_region is set.  each part starts with
+ * the same line style mask, just as if the line had been drawn once
+ * per rectangle.
+ */
+void region_abline(const Line *line, WORD wrt_mode, UWORD color)
+{
+    const ClipRegion *region = cur_region;
+    const VwkClip *clip;
+    const UWORD linemask = LN_MASK;
+    const WORD ymin = min(line->y1, line->y2);
+    const WORD ymax = max(line->y1, line->y2);
+    Line part;
+    WORD n;
+
+    cur_region = NULL;          /* so that abline() draws */
+
+    for (n = region->count, clip = region->rect; n > 0; n--, clip++) {
+        if (clip->ymn_clip > ymax)
+            break;              /* this & all following ones are below */
+        if (clip->ymx_clip < ymin)
+            continue;
+        part = *line;
+        if (clip_line(clip, &part)) {
+            LN_MASK = linemask;
+            abline(&part, wrt_mode, color);
+        }
+    }
+
+    cur_region = region;
+}
+
+#endif /* CONF_WITH_VDI_EXTENSIONS */
@@ -325,7 +325,7 @@ static void output_text(Vwk *vwk, WORD count, WORD *str, WORD width, JUSTINFO *j
                 ty1 = line->y1;
                 ty2 = line->y2;
 
-                if (clip_line(vwk, line))
+                if (clip_line(VDI_CLIP(vwk), line))
                     abline(line, vwk->wrt_mode, vwk->text_color);
 
                 line->x1 = tx1;
@@ -14,6 +14,7 @@
 
 #include "config.h"
 #include "portab.h"
+#include "asm.h"
 #include "intmath.h"
 
 #include "../bios/tosvars.h"
@@ -343,6 +344,64 @@ static void pre_blit(LOCALVARS *vars)
 }
 
 
+#if CONF_WITH_VDI_16BIT
+/*
+ * output a block to the screen in a 16-bit video mode
+ *
+ * the source block is single-plane, and is expanded directly to pixels.
+ * any thickening or skewing has already been done by pre_blit(), so we
+ * only need to handle lightening here.
+ */
+static void screen_blit_16(LOCALVARS *vars)
+{
+    UWORD *src, *dst;
+    UWORD fg, bg, lite, bits, bit;
+    WORD row, col, sbit;
+
+    fg = tc_palette[vars->forecol & 0xff];
+    bg = tc_palette[0];
+    lite = (vars->STYLE & F_LIGHT) ? LITEMASK : 0xffff;
+
+    /* we draw from the bottom up, like the assembler version */
+    dst = get_start_addr(vars->DESTX, vars->DESTY+vars->DELY-1);
+
+    for (row = vars->height; row > 0; row--) {
+        src = (UWORD *)vars->sform;
+        sbit = vars->tsdad;
+        bits = *src++ & lite;
+        bit = 0x8000 >> sbit;
+        for (col = 0; col < vars->width; col++) {
+            switch(vars->WRT_MODE) {
+            case 3:             /* reverse transparent */
+                if (!(bits & bit))
+                    dst[col] = fg;
+                break;
+            case 2:             /* xor */
+                if (bits & bit)
+                    dst[col] = ~dst[col];
+                break;
+            case 1:             /* transparent */
+                if (bits & bit)
+                    dst[col] = fg;
+                break;
+            default:            /* replace */
+                dst[col] = (bits & bit) ? fg : bg;
+                break;
+            }
+            if (++sbit == 16) {
+                sbit = 0;
+                bits = *src++ & lite;
+                bit = 0x8000;
+            } else bit >>= 1;
+        }
+        vars->sform += vars->s_next;
+        dst -= v_lin_wr / 2;
+        rolw1(lite);
+    }
+}
+#endif
+
+
 /*
  * output a block to the screen
  */
@@ -357,6 +416,13 @@ static void screen_blit(LOCALVARS *vars)
     vars->height = vars->DELY;
     vars->width = vars->DELX;
 
+#if CONF_WITH_VDI_PROFILE
+    vdi_pixels += (ULONG)vars->DELX * vars->DELY;
+#endif
+
+    cur_protect(vars->DESTX, vars->DESTY,
+                vars->DESTX + vars->DELX - 1, vars->DESTY + vars->DELY - 1);
+
     /*
      * calculate the starting address for the character to be copied
      */
@@ -365,6 +431,13 @@ static void screen_blit(LOCALVARS *vars)
     vars->sform += offset;
     vars->s_next = -vars->s_next;   /* we draw from the bottom up */
 
+#if CONF_WITH_VDI_16BIT
+    if (TRUECOLOR_MODE) {
+        screen_blit_16(vars);
+        return;
+    }
+#endif
+
     /*
      * calculate the screen address
      *
@@ -504,7 +577,8 @@ void text_blt(void)
     {
         if (vars.CHUP
          || ((vars.STYLE & F_SKEW) && clipped)
-         || (vars.STYLE & F_OUTLINE))
+         || (vars.STYLE & F_OUTLINE)
+         || TRUECOLOR_MODE)     /* screen_blit_16() doesn't skew/thicken */
         {
             pre_blit(&vars);
         }
@@ -0,0 +1,194 @@
+/*
+ * vdi_truecolor.c - drawing primitives for 16-bit (Falcon) video modes
+ *
+ * Copyright 2018 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#include "config.h"
+#include "portab.h"
+#include "asm.h"
+#include "intmath.h"
+#include "vdi_defs.h"
+#include "../bios/tosvars.h"
+#include "../bios/lineavars.h"
+
+#if CONF_WITH_VDI_16BIT
+
+/*
+ * In 16-bit Videl modes, the screen is not organised as interleaved
+ * bitplanes: each pixel is a single word, in RGB565 format.  The normal
+ * VDI drawing code, which processes one plane at a time, cannot handle
+ * this, so the functions here replace the basic primitives (rectangle
+ * fill, line drawing) when v_planes is 16.  Other parts of the VDI call
+ * TRUECOLOR_MODE-specific code in their own modules.
+ *
+ * The VDI passes colours to the drawing code as hardware colour register
+ * numbers (i.e. after mapping via MAP_COL[]), so tc_palette[] maps these
+ * register numbers to pixel values.  It is updated by set_color() in
+ * vdi_col.c in the same way that the hardware palette would be.
+ */
+UWORD tc_palette[256];
+
+
+/*
+ * tc_set_color - set a tc_palette[] entry from VDI-style RGB (0-1000)
+ */
+void tc_set_color(WORD hwreg, const WORD *rgb)
+{
+    UWORD r, g, b;
+
+    r = (rgb[0] * 31L + 500) / 1000;
+    g = (rgb[1] * 63L + 500) / 1000;
+    b = (rgb[2] * 31L + 500) / 1000;
+
+    tc_palette[hwreg & 0xff] = (r << 11) | (g << 5) | b;
+}
+
+
+/*
+ * tc_draw_rect - draw a (pattern-filled) rectangle
+ *
+ * this is the 16-bit equivalent of draw_rect_common().  multi-plane
+ * user-defined fill patterns are treated as single-plane.
+ */
+void tc_draw_rect(const VwkAttrib *attr, const Rect *rect)
+{
+    UWORD *addr, *work;
+    const WORD yinc = v_lin_wr >> 1;
+    const UWORD fg = tc_palette[attr->color & 0xff];
+    const UWORD bg = tc_palette[0];
+    const UWORD startbit = 0x8000 >> (rect->x1 & 0x0f);
+    WORD width, n, y;
+    UWORD pattern, bit;
+
+    addr = get_start_addr(rect->x1, rect->y1);
+    width = rect->x2 - rect->x1 + 1;
+
+    for (y = rect->y1; y <= rect->y2; y++, addr += yinc) {
+        pattern = attr->patptr[attr->patmsk & y];
+        work = addr;
+
+        switch(attr->wrt_mode) {
+        case 3:                 /* erase (reverse transparent) mode */
+            pattern = ~pattern;
+            /* drop through */
+        case 1:                 /* transparent mode */
+            for (n = width, bit = startbit; n > 0; n--, work++) {
+                if (pattern & bit)
+                    *work = fg;
+                rorw1(bit);
+            }
+            break;
+        case 2:                 /* xor mode */
+            for (n = width, bit = startbit; n > 0; n--, work++) {
+                if (pattern & bit)
+                    *work = ~*work;
+                rorw1(bit);
+            }
+            break;
+        default:                /* replace mode */
+            if (pattern == 0xffff) {
+                for (n = width; n > 0; n--)
+                    *work++ = fg;
+                break;
+            }
+            for (n = width, bit = startbit; n > 0; n--, work++) {
+                *work = (pattern & bit) ? fg : bg;
+                rorw1(bit);
+            }
+            break;
+        }
+    }
+}
+
+
+/*
+ * tc_draw_line - draw a line
+ *
+ * this is the 16-bit equivalent of draw_line() & vertical_line(): it
+ * handles lines in any direction, and updates LN_MASK in the same way.
+ */
+void tc_draw_line(const Line *line, WORD wrt_mode, UWORD color)
+{
+    UWORD *addr;
+    WORD dx, dy, xinc, yinc, eps, e1, e2, loopcnt;
+    WORD major, minor;          /* address increments along major/minor axes */
+    UWORD linemask = LN_MASK;
+    UWORD fg, bg;
+
+    fg = tc_palette[color & 0xff];
+    bg = tc_palette[0];
+    if (wrt_mode == 3)          /* reverse transparent: see draw_line() */
+        fg = tc_palette[~color & 0xff];
+
+    dx = line->x2 - line->x1;
+    dy = line->y2 - line->y1;
+    xinc = 1;
+    yinc = v_lin_wr >> 1;
+    if (dx < 0) {
+        dx = -dx;
+        xinc = -xinc;
+    }
+    if (dy < 0) {
+        dy = -dy;
+        yinc = -yinc;
+    }
+
+    /* always step along the major axis */
+    if (dx >= dy) {
+        major = xinc;
+        minor = yinc;
+    } else {
+        WORD t = dx;
+        dx = dy;
+        dy = t;
+        major = yinc;
+        minor = xinc;
+    }
+
+#if CONF_WITH_VDI_PROFILE
+    vdi_pixels += dx + 1;
+#endif
+
+    addr = get_start_addr(line->x1, line->y1);
+    e1 = 2 * dy;
+    eps = -dx;
+    e2 = 2 * dx;
+
+    for (loopcnt = dx; loopcnt >= 0; loopcnt--) {
+        rolw1(linemask);        /* get next bit of line style */
+        if (linemask & 0x0001) {
+            if (wrt_mode == 2)
+                *addr = ~*addr;
+            else *addr = fg;
+        } else if (wrt_mode == 0)
+            *addr = bg;
+        addr += major;
+        eps += e1;
+        if (eps >= 0) {
+            eps -= e2;
+            addr += minor;
+        }
+    }
+
+    LN_MASK = linemask;
+}
+
+
+/*
+ * tc_clear - fill the screen with colour register 0
+ */
+void tc_clear(void)
+{
+    UWORD *addr = (UWORD *)v_bas_ad;
+    const UWORD bg = tc_palette[0];
+    ULONG n;
+
+    for (n = (ULONG)v_lin_wr / 2 * V_REZ_VT; n > 0; n--)
+        *addr++ = bg;
+}
+
+#endif /* CONF_WITH_VDI_16BIT */